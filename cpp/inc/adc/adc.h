@@ -8,23 +8,56 @@
 #ifndef ADC_H
 #define ADC_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "adc/adc_telemetry.h"
+
 namespace nq {
 
+class Config;
+
 template <typename T> int sgn(T val) { return (T(0) < val) - (val < T(0)); }
 
+// Batch conversions of an ADC (convert calls) and converted currents
+struct ADCBatchCount {
+    uint64_t batches;
+    uint64_t conversions;
+};
+
 class ADC {
   public:
-    explicit ADC(const float min_curr, const float max_curr);
+    ADC(const Config &cfg, const float min_curr, const float max_curr);
     ADC() = delete;
     ADC(const ADC &) = delete;
     virtual ~ADC() = default;
 
     virtual float analog_digital_conversion(const float current) const = 0;
+    // Batch conversion of n currents (in == out is allowed)
+    virtual void convert(const float *in, float *out, size_t n) const;
     float clip(const float current) const;
+    // Statistics of the batch conversions (nullptr if disabled)
+    ADCTelemetry *get_telemetry() const { return telemetry_.get(); }
+    ADCBatchCount get_batch_count() const { return batch_count_; }
 
   protected:
+    void quantize(const float *in, float *out, size_t n, float step_size,
+                  float inv_step_size) const;
+    void record(const float *in, size_t n) const {
+        batch_count_.batches++;
+        batch_count_.conversions += n;
+        if (telemetry_) {
+            telemetry_->record(in, n);
+        }
+    }
+
     const float min_adc_curr_; // minimum current that can be converted (in uA)
     const float max_adc_curr_; // maximum current that can be converted (in uA)
+    const float clip_min_;     // alpha * min_adc_curr_
+    const float clip_max_;     // alpha * max_adc_curr_
+    std::unique_ptr<ADCTelemetry> telemetry_;
+    mutable ADCBatchCount batch_count_;
 };
 
 } // namespace nq
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef ADC_SCHEDULE_H
+#define ADC_SCHEDULE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "helper/definitions.h"
+
+namespace nq {
+
+// Analytical latency model of ADCs shared by several output lines. The lines
+// of an ADC are converted one after the other, the ADCs run in parallel. An
+// MVM converts its activated lines in rounds (batch conversions, e.g., one
+// per input bit), so it takes rounds * (largest number of activated lines of
+// one ADC) conversion cycles. No conversion is simulated: a single line range
+// is evaluated in closed form, only gated rows count the lines per ADC.
+class ADCSchedule {
+  public:
+    // num_rows: crossbar rows, share: output lines per ADC, latency: time of
+    // one conversion (in ns)
+    ADCSchedule(uint32_t num_rows, uint32_t share, ADCMuxOrder order,
+                float latency);
+    ADCSchedule(const ADCSchedule &) = delete;
+    virtual ~ADCSchedule() = default;
+
+    // Start an MVM with lines_per_row output lines per crossbar row (e.g.,
+    // one per weight segment)
+    void begin_mvm(uint32_t lines_per_row);
+    // Activate the output lines of the rows [begin, end)
+    void add_rows(uint32_t begin, uint32_t end);
+    // Finish the MVM with rounds batch conversions of the activated lines
+    void end_mvm(uint64_t rounds);
+    void reset();
+
+    uint32_t get_num_adcs() const { return num_adcs_; }
+    uint64_t get_cycles() const { return cycles_; }
+    float get_latency() const { return cycles_ * latency_; }
+    uint64_t get_total_cycles() const { return total_cycles_; }
+    uint64_t get_num_mvms() const { return num_mvms_; }
+
+  private:
+    uint32_t adc_of(uint32_t line) const;
+    uint32_t range_load(uint32_t begin, uint32_t end) const;
+    void count_lines(uint32_t begin, uint32_t end);
+
+    const uint32_t num_rows_;
+    const uint32_t share_;
+    const ADCMuxOrder order_;
+    const float latency_;
+    uint32_t lines_per_row_;
+    uint32_t num_adcs_;
+    // Activated lines of the current MVM: the first range, the lines per ADC
+    // if there is more than one range
+    uint32_t num_ranges_;
+    uint32_t range_begin_;
+    uint32_t range_end_;
+    std::vector<uint32_t> load_;
+    uint64_t cycles_; // Conversion cycles of the last MVM
+    uint64_t total_cycles_;
+    uint64_t num_mvms_;
+};
+
+} // namespace nq
+
+#endif
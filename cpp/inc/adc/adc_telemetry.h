@@ -0,0 +1,59 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef ADC_TELEMETRY_H
+#define ADC_TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nq {
+
+// Statistics of the batch conversions of an ADC: histogram of the output
+// codes, clip counts at both rails and the range of the pre-ADC currents.
+// Code c of a conversion is round(clip(current) / step_size) and is counted
+// in hist[(c - code_offset) >> code_shift].
+class ADCTelemetry {
+  public:
+    // inv_step_size == 0: no quantization (no histogram)
+    ADCTelemetry(float clip_min, float clip_max, float inv_step_size);
+    ADCTelemetry(const ADCTelemetry &) = delete;
+    virtual ~ADCTelemetry() = default;
+
+    // Largest number of histogram bins (2^MAX_HIST_BITS)
+    static constexpr uint32_t MAX_HIST_BITS = 16;
+
+    void record(const float *in, size_t n);
+    void reset();
+
+    const std::vector<uint64_t> &get_hist() const { return hist_; }
+    int64_t get_code_offset() const { return code_offset_; }
+    uint32_t get_code_shift() const { return code_shift_; }
+    uint64_t get_clip_low() const { return clip_low_; }
+    uint64_t get_clip_high() const { return clip_high_; }
+    uint64_t get_num_conversions() const { return num_conversions_; }
+    float get_min_current() const { return min_current_; }
+    float get_max_current() const { return max_current_; }
+
+  private:
+    const float clip_min_;
+    const float clip_max_;
+    const float inv_step_size_;
+    int64_t code_offset_; // Code of the first bin
+    uint32_t code_shift_; // log2 of the number of codes per bin
+    std::vector<uint64_t> hist_;
+    uint64_t clip_low_;  // Number of currents below clip_min
+    uint64_t clip_high_; // Number of currents above clip_max
+    uint64_t num_conversions_;
+    float min_current_; // Pre-ADC current range
+    float max_current_;
+};
+
+} // namespace nq
+
+#endif
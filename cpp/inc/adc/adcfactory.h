@@ -22,7 +22,7 @@ enum class ADCType {
 
 class ADCFactory {
   public:
-    static std::unique_ptr<ADC> createADC(ADCType type);
+    static std::unique_ptr<ADC> createADC(ADCType type, const Config &cfg);
 };
 
 } // namespace nq
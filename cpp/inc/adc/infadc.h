@@ -19,11 +19,12 @@ namespace nq {
 // ADC with infinite resolution
 class InfADC : public ADC {
   public:
-    InfADC();
+    explicit InfADC(const Config &cfg);
     InfADC(const InfADC &) = delete;
     virtual ~InfADC() = default;
 
     float analog_digital_conversion(const float current) const override;
+    void convert(const float *in, float *out, size_t n) const override;
 };
 
 } // namespace nq
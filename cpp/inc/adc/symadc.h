@@ -14,16 +14,18 @@ namespace nq {
 
 class SymADC : public ADC {
   public:
-    explicit SymADC();
+    explicit SymADC(const Config &cfg);
     SymADC(const SymADC &) = delete;
     virtual ~SymADC() = default;
 
     float analog_digital_conversion(const float current) const override;
+    void convert(const float *in, float *out, size_t n) const override;
 
   private:
-    float get_max_curr() const;
-    float get_min_curr() const;
-    const float step_size_; // ADC step size (delta)
+    static float get_max_curr(const Config &cfg);
+    static float get_min_curr(const Config &cfg);
+    const float step_size_;     // ADC step size (delta)
+    const float inv_step_size_; // 1 / step_size_
 };
 
 } // namespace nq
@@ -17,6 +17,7 @@
 
 #include "adc/adcfactory.h"
 #include "helper/definitions.h"
+#include "helper/storage.h"
 #include "mapping/mapper.h"
 #include "nlohmann/json.hpp"
 #include "xbar/crossbar.h"
@@ -31,20 +32,28 @@ class Config {
     Config &operator=(const Config &) = delete;
     virtual ~Config();
 
+    // Global config of the C/Python interface and the tools. Simulator
+    // objects (Crossbar, Mapper, ADC, ReadDisturb) take their config by
+    // reference instead, so independent objects can run on different threads.
     static Config &get_cfg();
+    // Independent configs, e.g., for parallel sweep workers
+    static std::unique_ptr<Config> create();
+    std::unique_ptr<Config> clone() const;
+    // Loads a JSON config file or a binary config written by save_cfg()
     bool load_cfg(const char *cfg_file);
-    bool is_int_mapping(const MappingMode &mode);
-    bool is_bnn_mapping(const MappingMode &mode);
-    bool is_tnn_mapping(const MappingMode &mode);
-    bool update_cfg(const char *json_string, bool *recreate_xbar = nullptr,
-                    const std::vector<std::string> &recreation_keys = {
-                        "M", "N", "SPLIT", "digital_only", "HRS", "LRS",
-                        "adc_type", "alpha", "resolution", "m_mode",
-                        "HRS_NOISE", "LRS_NOISE", "read_disturb", "V_read",
-                        "t_read", "read_disturb_update_freq",
-                        "read_disturb_mitigation_strategy",
-                        "read_disturb_mitigation_fp",
-                        "read_disturb_update_tolerance"});
+    // Writes the config in a compact binary format (MessagePack)
+    bool save_cfg(const char *cfg_file) const;
+    bool is_int_mapping(const MappingMode &mode) const;
+    bool is_bnn_mapping(const MappingMode &mode) const;
+    bool is_tnn_mapping(const MappingMode &mode) const;
+    // update: most severe crossbar update required by the changed keys
+    bool update_cfg(const char *json_string, ConfigUpdate *update = nullptr);
+    bool update_cfg(const nlohmann::json &updates,
+                    ConfigUpdate *update = nullptr);
+    static ConfigUpdate key_update(const std::string &key);
+    // Hash of all parameters that affect the simulation (e.g., as key of
+    // cached crossbars). Equal configs have equal fingerprints.
+    uint64_t fingerprint() const { return fingerprint_; }
 
     // Matrix dimensions MxN
     uint32_t M;
@@ -76,10 +85,34 @@ class Config {
     // Verbose output
     bool verbose;
 
+    // Use the sparse MVM kernels if the fraction of non-HRS cells is below
+    // this threshold (0: always dense)
+    float sparse_threshold;
+
+    // Record ADC statistics (code histogram, clipping, current range) of
+    // the analog MVM
+    bool adc_telemetry;
+
+    // ADC sharing model: output lines per ADC (0: off), conversion time of
+    // one line (in ns) and assignment of the lines to the ADCs
+    int32_t adc_share;
+    float adc_latency;
+    ADCMuxOrder adc_mux_order;
+
+    // Backing memory of the state planes (gd_*, ia_*, cycles_*, consecutive
+    // reads): HEAP, MMAP (file in storage_dir, default: temp directory) or
+    // HUGEPAGE
+    StorageType storage;
+    std::string storage_dir;
+
     // State variability: standard deviation of a gaussian distribution (in uA)
     float HRS_NOISE;
     float LRS_NOISE;
 
+    // Use the digital MVM if the analog config is provably ideal
+    // (INF_ADC, no state variability, no read disturb)
+    bool digital_shortcut;
+
     // Read disturb parameters
     // V_read: read voltage (in V, negative)
     // t_read: time of a read pulse (in s)
@@ -105,8 +138,8 @@ class Config {
   private:
     Config();
     bool apply_config();
-    static Config cfg_;
     nlohmann::json cfg_data_;
+    uint64_t fingerprint_;
 };
 
 } // namespace nq
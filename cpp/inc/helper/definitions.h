@@ -9,6 +9,7 @@
 #define DEFINITIONS_H
 
 #include <map>
+#include <string>
 
 namespace nq {
 
@@ -37,6 +38,16 @@ enum class MappingMode {
     TNN_V
 };
 
+// Crossbar state that is invalidated by a config update. Each level includes
+// the updates of the lower levels.
+enum class ConfigUpdate {
+    NONE,   // e.g., verbose, sparse_threshold (used by the next write)
+    ADC,    // ADC parameters: rebuild the ADC
+    ANALOG, // Cell currents, state variability, read disturb: recompute the
+            // analog state from the programmed weights
+    REBUILD // Geometry, mapping, storage: recreate the crossbar
+};
+
 const std::map<MappingMode, MappingType> mode_to_type = {
     {MappingMode::I_DIFF_W_DIFF_1XB, MappingType::INT},
     {MappingMode::I_DIFF_W_DIFF_2XB, MappingType::INT},
@@ -99,6 +110,10 @@ static std::string m_mode_to_string(MappingMode mode) {
 
 enum class ReadDisturbMitigationStrategy { SOFTWARE, CELL_BASED, OFF };
 
+// Output lines of a shared ADC: SEQUENTIAL (neighboring lines) or INTERLEAVED
+// (every num_adcs-th line)
+enum class ADCMuxOrder { SEQUENTIAL, INTERLEAVED };
+
 } // namespace nq
 
 #endif
@@ -0,0 +1,176 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "helper/storage.h"
+
+namespace nq {
+
+// Binary snapshot file (native byte order):
+//   SnapshotHeader
+//   SnapshotSection[num_sections]
+//   section data, each section starts at a multiple of SNAPSHOT_ALIGN
+// The data of a section is a dense row-major rows x cols matrix of dtype.
+// Because of the alignment, large matrices can be memory-mapped directly,
+// e.g., with numpy.memmap(path, dtype, 'r', offset, (rows, cols)).
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint64_t SNAPSHOT_ALIGN = 4096;
+
+enum class SnapshotType : uint32_t {
+    INT32 = 0,
+    UINT32 = 1,
+    UINT64 = 2,
+    FLOAT32 = 3
+};
+
+struct SnapshotHeader {
+    char magic[8]; // "ACSSNAP"
+    uint32_t version;
+    uint32_t num_sections;
+};
+
+struct SnapshotSection {
+    char name[32];
+    SnapshotType dtype;
+    uint32_t elem_size;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t offset; // Byte offset of the data in the file
+};
+
+template <typename T> struct SnapshotTypeOf;
+template <> struct SnapshotTypeOf<int32_t> {
+    static constexpr SnapshotType value = SnapshotType::INT32;
+};
+template <> struct SnapshotTypeOf<uint32_t> {
+    static constexpr SnapshotType value = SnapshotType::UINT32;
+};
+template <> struct SnapshotTypeOf<uint64_t> {
+    static constexpr SnapshotType value = SnapshotType::UINT64;
+};
+template <> struct SnapshotTypeOf<float> {
+    static constexpr SnapshotType value = SnapshotType::FLOAT32;
+};
+
+// Collects sections and writes them to a snapshot file. The data is
+// referenced (not copied) until write() is called.
+class SnapshotWriter {
+  public:
+    SnapshotWriter() = default;
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    virtual ~SnapshotWriter() = default;
+
+    template <typename T> void add(const char *name, const Plane<T> &mat);
+    template <typename T> void add(const char *name, const std::vector<T> &vec);
+    // Small vectors that are owned by the writer
+    template <typename T> void add(const char *name, std::vector<T> &&vec);
+    bool write(const std::string &path) const;
+
+  private:
+    void add_section(const char *name, SnapshotType dtype, uint32_t elem_size,
+                     uint64_t rows, uint64_t cols,
+                     std::function<void(std::ofstream &)> write_data);
+
+    std::vector<SnapshotSection> sections_;
+    std::vector<std::function<void(std::ofstream &)>> write_data_;
+};
+
+// Memory-maps a snapshot file and copies sections into existing containers.
+// The dimensions of a container must match the dimensions of its section.
+class SnapshotReader {
+  public:
+    explicit SnapshotReader(const std::string &path);
+    SnapshotReader(const SnapshotReader &) = delete;
+    virtual ~SnapshotReader();
+
+    bool is_open() const { return data_ != nullptr; }
+    bool has(const char *name) const { return find(name) != nullptr; }
+    template <typename T> bool read(const char *name, Plane<T> &mat) const;
+    template <typename T>
+    bool read(const char *name, std::vector<T> &vec) const;
+
+  private:
+    const SnapshotSection *find(const char *name) const;
+    const void *section_data(const char *name, SnapshotType dtype,
+                             uint64_t rows, uint64_t cols) const;
+
+    const uint8_t *data_;
+    size_t size_;
+    std::vector<SnapshotSection> sections_;
+};
+
+template <typename T>
+void SnapshotWriter::add(const char *name, const Plane<T> &mat) {
+    const uint64_t cols = mat.empty() ? 0 : mat[0].size();
+    add_section(name, SnapshotTypeOf<T>::value, sizeof(T), mat.size(), cols,
+                [&mat](std::ofstream &out) {
+                    for (const auto &row : mat) {
+                        out.write(reinterpret_cast<const char *>(row.data()),
+                                  row.size() * sizeof(T));
+                    }
+                });
+}
+
+template <typename T>
+void SnapshotWriter::add(const char *name, const std::vector<T> &vec) {
+    add_section(name, SnapshotTypeOf<T>::value, sizeof(T), 1, vec.size(),
+                [&vec](std::ofstream &out) {
+                    out.write(reinterpret_cast<const char *>(vec.data()),
+                              vec.size() * sizeof(T));
+                });
+}
+
+template <typename T>
+void SnapshotWriter::add(const char *name, std::vector<T> &&vec) {
+    const uint64_t cols = vec.size();
+    add_section(name, SnapshotTypeOf<T>::value, sizeof(T), 1, cols,
+                [vec = std::move(vec)](std::ofstream &out) {
+                    out.write(reinterpret_cast<const char *>(vec.data()),
+                              vec.size() * sizeof(T));
+                });
+}
+
+template <typename T>
+bool SnapshotReader::read(const char *name, Plane<T> &mat) const {
+    const uint64_t cols = mat.empty() ? 0 : mat[0].size();
+    const T *src = static_cast<const T *>(
+        section_data(name, SnapshotTypeOf<T>::value, mat.size(), cols));
+    if (src == nullptr) {
+        return false;
+    }
+    for (auto &row : mat) {
+        std::copy(src, src + cols, row.begin());
+        src += cols;
+    }
+    return true;
+}
+
+template <typename T>
+bool SnapshotReader::read(const char *name, std::vector<T> &vec) const {
+    const T *src = static_cast<const T *>(
+        section_data(name, SnapshotTypeOf<T>::value, 1, vec.size()));
+    if (src == nullptr) {
+        return false;
+    }
+    std::copy(src, src + vec.size(), vec.begin());
+    return true;
+}
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nq {
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// The blocking push()/pop() spin and yield while the queue is full/empty.
+template <typename T> class SpscQueue {
+  public:
+    explicit SpscQueue(size_t capacity) :
+        slots_(capacity + 1), head_(0), tail_(0) {}
+    SpscQueue(const SpscQueue &) = delete;
+    virtual ~SpscQueue() = default;
+
+    // item is only moved if it was added
+    bool try_push(T &&item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) % slots_.size();
+        if (next == head_.load(std::memory_order_acquire)) {
+            return false; // Full
+        }
+        slots_[tail] = std::move(item);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false; // Empty
+        }
+        item = std::move(slots_[head]);
+        head_.store((head + 1) % slots_.size(), std::memory_order_release);
+        return true;
+    }
+
+    void push(T &&item) {
+        while (!try_push(std::move(item))) {
+            std::this_thread::yield();
+        }
+    }
+
+    void pop(T &item) {
+        while (!try_pop(item)) {
+            std::this_thread::yield();
+        }
+    }
+
+  private:
+    std::vector<T> slots_; // One slot stays empty to distinguish full/empty
+    alignas(64) std::atomic<size_t> head_; // Next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail_; // Next slot to push (producer)
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace nq {
+
+class Config;
+
+// State plane of a crossbar (e.g., gd_p_, ia_p_, cycles_p_). The rows are
+// allocated from the storage of the crossbar, copies use the heap.
+template <typename T> using Plane = std::vector<std::pmr::vector<T>>;
+
+enum class StorageType {
+    HEAP,    // Default allocator
+    MMAP,    // Shared mapping of an unlinked file in storage_dir
+    HUGEPAGE // Anonymous mapping with transparent huge pages
+};
+
+// Arena for the state planes of a crossbar. Memory is mapped in chunks and
+// released when the arena is destroyed (rows are never freed individually).
+// With MMAP, the OS can write cold pages back to the file instead of keeping
+// them in RAM or swap.
+class StorageArena : public std::pmr::memory_resource {
+  public:
+    StorageArena(StorageType type, const std::string &dir);
+    StorageArena(const StorageArena &) = delete;
+    virtual ~StorageArena();
+
+    // nullptr for StorageType::HEAP
+    static std::unique_ptr<StorageArena> create_from_config(const Config &cfg);
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+  private:
+    static constexpr size_t CHUNK_SIZE = 64 << 20;
+    void map_chunk(size_t min_bytes);
+
+    const StorageType type_;
+    int fd_;           // Backing file (MMAP)
+    size_t file_size_; // Current size of the backing file
+    std::vector<std::pair<void *, size_t>> chunks_;
+    uint8_t *cur_; // Next free byte of the current chunk
+    size_t left_;  // Free bytes of the current chunk
+};
+
+// rows x cols plane with all elements set to value (storage == nullptr: heap)
+template <typename T>
+Plane<T> make_plane(size_t rows, size_t cols, T value,
+                    std::pmr::memory_resource *storage) {
+    if (storage == nullptr) {
+        storage = std::pmr::get_default_resource();
+    }
+    Plane<T> plane;
+    plane.reserve(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        plane.emplace_back(cols, value, storage);
+    }
+    return plane;
+}
+
+} // namespace nq
+
+#endif
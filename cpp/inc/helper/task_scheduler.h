@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nq {
+
+// Work-stealing scheduler: every worker has its own deque. A worker takes
+// tasks from the back of its own deque (tasks spawned by its last task
+// first) and steals from the front of the other deques when it runs out of
+// work, or sleeps until a task is queued. The calling thread of run() is
+// worker 0, the other workers are persistent threads.
+class TaskScheduler {
+  public:
+    using Task = std::function<void()>;
+
+    // num_threads: workers including the calling thread of run()
+    // (0: one per hardware thread)
+    explicit TaskScheduler(uint32_t num_threads);
+    TaskScheduler(const TaskScheduler &) = delete;
+    virtual ~TaskScheduler();
+
+    // Runs the tasks and all tasks spawned by them, returns when all are
+    // done
+    void run(std::vector<Task> tasks);
+    // Adds a task to the deque of the current worker (only within a task)
+    void spawn(Task task);
+    uint32_t num_threads() const { return workers_.size(); }
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(uint32_t id);
+    void execute(uint32_t id);
+    bool next_task(uint32_t id, Task &task);
+    void push_task(uint32_t id, Task task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> pending_; // Tasks not finished yet
+    std::atomic<size_t> queued_;  // Tasks in the deques
+
+    // Workers without a task wait for queued_ > 0 or pending_ == 0
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // Start/stop of the persistent threads
+    std::mutex run_mutex_;
+    std::condition_variable run_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_; // Number of run() calls
+    uint32_t active_;     // Threads still working on the current run()
+    bool stop_;
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nq {
+
+// Binary trace file of cpy_mtrx/exe_mvm calls (native byte order):
+//   magic "ACSTRACE", uint32_t version
+//   records until the end of the file:
+//     uint8_t op, uint16_t name length, name, int32_t m_matrix, n_matrix
+//     CPY: mat (m x n)
+//     MVM: vec (n), res before the call (m), res after the call (m)
+// Each operand array starts with one byte that holds its element width. The
+// elements are stored with the smallest width (1, 2 or 4 bytes) that fits
+// all of its values, e.g., ternary weights need one byte per element.
+constexpr uint32_t TRACE_VERSION = 1;
+
+enum class TraceOp : uint8_t { CPY = 0, MVM = 1 };
+
+struct TraceRecord {
+    TraceOp op;
+    std::string name; // Layer name
+    int32_t m_matrix;
+    int32_t n_matrix;
+    std::vector<int32_t> mat;     // CPY
+    std::vector<int32_t> vec;     // MVM
+    std::vector<int32_t> res_in;  // MVM
+    std::vector<int32_t> res_out; // MVM
+};
+
+class TraceWriter {
+  public:
+    TraceWriter() = default;
+    TraceWriter(const TraceWriter &) = delete;
+    virtual ~TraceWriter() = default;
+
+    bool open(const std::string &path);
+    void close();
+    bool is_open() const { return out_.is_open(); }
+
+    void record_cpy(const int32_t *mat, int32_t m_matrix, int32_t n_matrix,
+                    const char *name);
+    void record_mvm(const int32_t *res_in, const int32_t *res_out,
+                    const int32_t *vec, int32_t m_matrix, int32_t n_matrix,
+                    const char *name);
+
+  private:
+    void write_head(TraceOp op, const char *name, int32_t m_matrix,
+                    int32_t n_matrix);
+    void write_array(const int32_t *data, size_t size);
+
+    std::ofstream out_;
+    std::mutex mutex_;
+    std::vector<char> buf_;
+};
+
+class TraceReader {
+  public:
+    explicit TraceReader(const std::string &path);
+    TraceReader(const TraceReader &) = delete;
+    virtual ~TraceReader() = default;
+
+    bool is_open() const { return valid_; }
+    // Reads the next record (only the arrays of its op are set), false at
+    // the end of the trace or on errors
+    bool next(TraceRecord &rec);
+    // True if next() stopped because of a truncated or corrupted record
+    bool failed() const { return failed_; }
+
+  private:
+    bool read_array(std::vector<int32_t> &data, size_t size);
+
+    std::ifstream in_;
+    bool valid_;
+    bool failed_;
+    std::vector<char> buf_;
+};
+
+// Reads all records of a trace file
+bool read_trace(const std::string &path, std::vector<TraceRecord> &records);
+
+// Trace recorder of the C interface, started with start_trace() or the
+// environment variable ACS_TRACE=<file>
+TraceWriter &get_trace_recorder();
+
+} // namespace nq
+
+#endif
@@ -17,17 +17,21 @@ namespace nq {
 // Mapping BNN I: i_NN = 2 v_D - 1, w_NN = g_D+ - g_D-
 class MapperBnnI : public Mapper {
   public:
-    MapperBnnI();
+    explicit MapperBnnI(const Config &cfg,
+                        std::shared_ptr<ProgrammedWeights> weights = nullptr);
     MapperBnnI(const MapperBnnI &) = delete;
     virtual ~MapperBnnI();
 
-    void d_write(const int32_t *mat, int32_t m_matrix,
-                 int32_t n_matrix) override;
-    void a_write(int32_t m_matrix, int32_t n_matrix) override;
+    void d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                 int32_t m_matrix, int32_t n_matrix) override;
+    void a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                 int32_t n_end) override;
     void d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
     void a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
 
   private:
     // Temporary data for MVM
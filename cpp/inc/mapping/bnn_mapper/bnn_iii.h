@@ -17,17 +17,21 @@ namespace nq {
 // Mapping BNN III: i_NN = v_D+ - v_D-, w_NN = 2 g_D - 1
 class MapperBnnIII : public Mapper {
   public:
-    MapperBnnIII();
+    explicit MapperBnnIII(const Config &cfg,
+                          std::shared_ptr<ProgrammedWeights> weights = nullptr);
     MapperBnnIII(const MapperBnnIII &) = delete;
     virtual ~MapperBnnIII();
 
-    void d_write(const int32_t *mat, int32_t m_matrix,
-                 int32_t n_matrix) override;
-    void a_write(int32_t m_matrix, int32_t n_matrix) override;
+    void d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                 int32_t m_matrix, int32_t n_matrix) override;
+    void a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                 int32_t n_end) override;
     void d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
     void a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
 
   private:
     // Temporary data for MVM
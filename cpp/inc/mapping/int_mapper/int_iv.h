@@ -17,19 +17,36 @@ namespace nq {
 // Mapping: I_UINT_W_DIFF
 class MapperIntIV : public Mapper {
   public:
-    MapperIntIV();
+    explicit MapperIntIV(const Config &cfg,
+                         std::shared_ptr<ProgrammedWeights> weights = nullptr);
     MapperIntIV(const MapperIntIV &) = delete;
     virtual ~MapperIntIV();
 
-    void d_write(const int32_t *mat, int32_t m_matrix,
-                 int32_t n_matrix) override;
-    void a_write(int32_t m_matrix, int32_t n_matrix) override;
+    void d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                 int32_t m_matrix, int32_t n_matrix) override;
+    void a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                 int32_t n_end) override;
     void d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
     void a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-               int32_t m_matrix, int32_t n_matrix) override;
+               int32_t row_off, int32_t col_off, int32_t m_matrix,
+               int32_t n_matrix) override;
 
   private:
+    template <uint32_t NUM_SEG, uint32_t I_BIT>
+    void d_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                      int32_t col_off, int32_t m_matrix, int32_t n_matrix);
+    template <uint32_t NUM_SEG, uint32_t I_BIT>
+    void a_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                      int32_t col_off, int32_t m_matrix, int32_t n_matrix);
+
+    // Kernels specialized for the current config
+    void (MapperIntIV::*d_mvm_)(int32_t *, const int32_t *, int32_t, int32_t,
+                                int32_t, int32_t);
+    void (MapperIntIV::*a_mvm_)(int32_t *, const int32_t *, int32_t, int32_t,
+                                int32_t, int32_t);
+
     // Temporary data for MVM
     std::vector<int32_t> tmp_out_int_;
     std::vector<float> tmp_out_fp_;
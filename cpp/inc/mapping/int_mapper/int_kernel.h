@@ -0,0 +1,183 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef INT_KERNEL_H
+#define INT_KERNEL_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "adc/adc.h"
+#include "mapping/sparse_pattern.h"
+
+namespace nq {
+
+// Building blocks of the bit-serial INT mappings.
+// NUM_SEG (number of weight segments) is a template parameter so that the
+// segment loops of the specialized kernels are unrolled. NUM_SEG = 0 selects
+// the runtime value (generic kernel).
+namespace int_kernel {
+
+template <uint32_t VAL> constexpr uint32_t value_or(const uint32_t runtime) {
+    return VAL ? VAL : runtime;
+}
+
+// The kernels read the cell rows [row_off, row_off + rows) and the columns
+// [col_off, col_off + n_matrix), i.e., g[t_m][n] is the cell
+// (row_off + t_m, col_off + n). A sparse pattern requires col_off = 0.
+
+// tmp[t_m] += sum_n (g_a[t_m][n] - g_b[t_m][n]) * v[n]
+// With a sparse pattern, only the non-HRS cells (g_a != g_b) are visited.
+inline void mac(int32_t *tmp, const Plane<int32_t> &g_a,
+                const Plane<int32_t> &g_b, const int32_t *v, uint32_t row_off,
+                uint32_t rows, int32_t col_off, int32_t n_matrix,
+                const SparsePattern *sparse = nullptr) {
+    for (size_t t_m = 0; t_m < rows; ++t_m) {
+        const int32_t *a = g_a[row_off + t_m].data() + col_off;
+        const int32_t *b = g_b[row_off + t_m].data() + col_off;
+        int32_t acc = 0;
+        if (sparse) {
+            for (const uint32_t *n = sparse->row_begin(row_off + t_m);
+                 n != sparse->row_end(row_off + t_m); ++n) {
+                acc += (a[*n] - b[*n]) * v[*n];
+            }
+        } else {
+            for (size_t n = 0; n < n_matrix; ++n) {
+                acc += (a[n] - b[n]) * v[n];
+            }
+        }
+        tmp[t_m] += acc;
+    }
+}
+
+// tmp[t_m] += sum_n g[t_m][n] * v[n]
+inline void mac(int32_t *tmp, const Plane<int32_t> &g, const int32_t *v,
+                uint32_t row_off, uint32_t rows, int32_t col_off,
+                int32_t n_matrix) {
+    for (size_t t_m = 0; t_m < rows; ++t_m) {
+        const int32_t *a = g[row_off + t_m].data() + col_off;
+        int32_t acc = 0;
+        for (size_t n = 0; n < n_matrix; ++n) {
+            acc += a[n] * v[n];
+        }
+        tmp[t_m] += acc;
+    }
+}
+
+// Columns n of the input bit plane with (v[n] >> bit) & 1 = 1
+inline uint32_t active_columns(uint32_t *cols, const int32_t *v, uint32_t bit,
+                               int32_t n_matrix) {
+    uint32_t num_cols = 0;
+    for (size_t n = 0; n < n_matrix; ++n) {
+        cols[num_cols] = n;
+        num_cols += (v[n] >> bit) & 1;
+    }
+    return num_cols;
+}
+
+// Analog MAC of one input bit plane:
+// tmp[t_m] += sum_n (i_a[t_m][n] - i_b[t_m][n]) * ((v[n] >> bit) & 1)
+// Without a sparse weight pattern, only the active input columns (collected in
+// cols, size >= n_matrix) are visited and an all-zero bit plane is skipped.
+// Inactive columns and HRS cell pairs (no state variability) add exactly 0, so
+// the float result is identical to the dense evaluation.
+inline void mac_bit_plane(float *tmp, const Plane<float> &i_a,
+                          const Plane<float> &i_b, const int32_t *v,
+                          uint32_t bit, uint32_t row_off, uint32_t rows,
+                          int32_t col_off, int32_t n_matrix, uint32_t *cols,
+                          const SparsePattern *sparse = nullptr) {
+    if (sparse) {
+        for (size_t t_m = 0; t_m < rows; ++t_m) {
+            const float *a = i_a[row_off + t_m].data();
+            const float *b = i_b[row_off + t_m].data();
+            float acc = tmp[t_m];
+            for (const uint32_t *n = sparse->row_begin(row_off + t_m);
+                 n != sparse->row_end(row_off + t_m); ++n) {
+                acc += (a[*n] - b[*n]) * ((v[*n] >> bit) & 1);
+            }
+            tmp[t_m] = acc;
+        }
+        return;
+    }
+
+    const uint32_t num_cols = active_columns(cols, v, bit, n_matrix);
+    if (num_cols == 0) {
+        return;
+    }
+    for (size_t t_m = 0; t_m < rows; ++t_m) {
+        const float *a = i_a[row_off + t_m].data() + col_off;
+        const float *b = i_b[row_off + t_m].data() + col_off;
+        float acc = tmp[t_m];
+        for (size_t c = 0; c < num_cols; ++c) {
+            acc += a[cols[c]] - b[cols[c]];
+        }
+        tmp[t_m] = acc;
+    }
+}
+
+// tmp[t_m] += sum_n i[t_m][n] * ((v[n] >> bit) & 1)
+inline void mac_bit_plane(float *tmp, const Plane<float> &i, const int32_t *v,
+                          uint32_t bit, uint32_t row_off, uint32_t rows,
+                          int32_t col_off, int32_t n_matrix, uint32_t *cols) {
+    const uint32_t num_cols = active_columns(cols, v, bit, n_matrix);
+    if (num_cols == 0) {
+        return;
+    }
+    for (size_t t_m = 0; t_m < rows; ++t_m) {
+        const float *a = i[row_off + t_m].data() + col_off;
+        float acc = tmp[t_m];
+        for (size_t c = 0; c < num_cols; ++c) {
+            acc += a[cols[c]];
+        }
+        tmp[t_m] = acc;
+    }
+}
+
+// Addition of the partial results caused by splitted weights (digital)
+// res[m] += sum_s tmp[m * num_seg + s] << shift[s]
+template <uint32_t NUM_SEG>
+inline void shift_add(int32_t *res, const int32_t *tmp, const uint32_t *shift,
+                      uint32_t num_seg, int32_t m_matrix) {
+    const uint32_t segs = value_or<NUM_SEG>(num_seg);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        int32_t acc = 0;
+        for (size_t s = 0; s < segs; ++s) {
+            acc += tmp[m * segs + s] << shift[s];
+        }
+        res[m] += acc;
+    }
+}
+
+// Addition of the partial results caused by splitted weights (analog)
+// res[m] += sign * round(ADC(tmp[m * num_seg + s]) / step[s] *
+//                        2^(shift[s] + bit))
+// tmp is converted in place by a single batch ADC call.
+// The multiplication with a power of two is exact, so the result is identical
+// to the evaluation with std::pow.
+template <uint32_t NUM_SEG, typename T>
+inline void adc_shift_add(T *res, float *tmp, const ADC &adc,
+                          const float *step, const uint32_t *shift,
+                          uint32_t num_seg, uint32_t bit, int32_t m_matrix,
+                          int32_t sign = 1) {
+    const uint32_t segs = value_or<NUM_SEG>(num_seg);
+    adc.convert(tmp, tmp, m_matrix * segs);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        for (size_t s = 0; s < segs; ++s) {
+            const float scale =
+                static_cast<float>(uint64_t(1) << (shift[s] + bit));
+            res[m] += sign * static_cast<int32_t>(std::round(
+                              tmp[m * segs + s] / step[s] * scale));
+        }
+    }
+}
+
+} // namespace int_kernel
+
+} // namespace nq
+
+#endif
@@ -11,80 +11,218 @@
 #include <cstdint>
 #include <memory>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include "adc/adc.h"
+#include "helper/snapshot.h"
+#include "helper/storage.h"
+#include "mapping/packed_gemv.h"
+#include "mapping/programmed_weights.h"
+#include "mapping/sparse_pattern.h"
 #include "xbar/read_disturb.h"
 
 namespace nq {
 
+class Config;
+
+// The mapper reads its parameters from cfg, which must outlive the mapper
 class Mapper {
   public:
-    Mapper(bool is_diff_weight_mapping);
+    // weights: programmed weights of a mapper with the same config to share
+    // (copy-on-write), nullptr: the mapper allocates its own
+    Mapper(const Config &cfg, bool is_diff_weight_mapping,
+           std::shared_ptr<ProgrammedWeights> weights = nullptr);
     Mapper(const Mapper &) = delete;
     virtual ~Mapper() = default;
 
-    virtual void d_write(const int32_t *mat, int32_t m_matrix,
-                         int32_t n_matrix) = 0;
-    virtual void a_write(int32_t m_matrix, int32_t n_matrix) = 0;
+    // Replace the written matrix by mat
+    void write(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
+    // Write mat to the rows [row_off, row_off + m_matrix) and columns
+    // [col_off, col_off + n_matrix) of the written matrix, the other cells
+    // are kept. The written matrix grows if the region exceeds it.
+    void write_region(const int32_t *mat, int32_t row_off, int32_t col_off,
+                      int32_t m_matrix, int32_t n_matrix);
+    // Program the weights of mat at the offsets (use write/write_region)
+    virtual void d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                         int32_t m_matrix, int32_t n_matrix) = 0;
+    // Program the currents of the matrix rows [m_begin, m_end) and the
+    // columns [n_begin, n_end) from the programmed weights
+    virtual void a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                         int32_t n_end) = 0;
+    // res += W * vec for the matrix W in the rows [row_off, row_off +
+    // m_matrix) and columns [col_off, col_off + n_matrix) of the written
+    // matrix, only the cells of W are read
     virtual void d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) = 0;
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) = 0;
     virtual void a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) = 0;
-    static std::unique_ptr<Mapper> create_from_config();
-    const std::vector<std::vector<int32_t>> &get_gd_p() const;
-    const std::vector<std::vector<int32_t>> &get_gd_m() const;
-    const std::vector<std::vector<float>> &get_ia_p() const;
-    const std::vector<std::vector<float>> &get_ia_m() const;
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) = 0;
+    static std::unique_ptr<Mapper>
+    create_from_config(const Config &cfg,
+                       std::shared_ptr<ProgrammedWeights> weights = nullptr);
+    const Plane<int32_t> &get_gd_p() const;
+    const Plane<int32_t> &get_gd_m() const;
+    const Plane<float> &get_ia_p() const;
+    const Plane<float> &get_ia_m() const;
     void rd_update_conductance(std::shared_ptr<const ReadDisturb> rd_model,
                                const uint64_t read_num);
-    void rd_update_conductance(
-        std::shared_ptr<const ReadDisturb> rd_model,
-        const std::vector<std::vector<uint64_t>> &consecutive_reads_p,
-        const std::vector<std::vector<uint64_t>> &consecutive_reads_m);
+    void rd_update_conductance(std::shared_ptr<const ReadDisturb> rd_model,
+                               const Plane<uint64_t> &consecutive_reads_p,
+                               const Plane<uint64_t> &consecutive_reads_m);
     bool rd_check_software_refresh(std::shared_ptr<const ReadDisturb> rd_model,
                                    const uint64_t read_num,
                                    const uint64_t write_num);
     int rd_cell_based_refresh(std::shared_ptr<ReadDisturb> rd_model);
     bool is_diff_weight_mapping() const;
+    ADCTelemetry *get_adc_telemetry() const { return adc_->get_telemetry(); }
+    ADCBatchCount get_adc_batch_count() const {
+        return adc_->get_batch_count();
+    }
+    void save(SnapshotWriter &snapshot) const;
+    bool load(const SnapshotReader &snapshot);
+    // Reconfiguration, the programmed weights (gd_*) are kept
+    void update_adc();
+    void update_analog();
+    // Mapper that shares the programmed weights until the next write of
+    // either mapper. cfg may differ from the config of the mapper only in
+    // keys below ConfigUpdate::REBUILD. The currents must be written with
+    // a_write.
+    std::unique_ptr<Mapper> replicate(const Config &cfg) const {
+        return create_from_config(cfg, weights_);
+    }
+    // Number of mappers sharing the programmed weights
+    long get_weight_users() const { return weights_.use_count(); }
 
   protected:
-    void d_write_diff(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
-    void d_write_diff_bnn(const int32_t *mat, int32_t m_matrix,
-                          int32_t n_matrix);
-    void d_write_diff_tnn(const int32_t *mat, int32_t m_matrix,
-                          int32_t n_matrix);
-    void d_write_offs(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
-    void d_write_tc_tnn(const int32_t *mat, int32_t m_matrix, int32_t n_matrix,
-                        bool offset);
-    void a_write_p_m(int32_t m_matrix, int32_t n_matrix);
-    void a_write_p_m_bnn_tnn(int32_t m_matrix, int32_t n_matrix);
-    void a_write_p(int32_t m_matrix, int32_t n_matrix);
-    void a_write_p_bnn(int32_t m_matrix, int32_t n_matrix);
+    void d_write_diff(const int32_t *mat, int32_t row_off, int32_t col_off,
+                      int32_t m_matrix, int32_t n_matrix);
+    void d_write_diff_bnn(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix);
+    void d_write_diff_tnn(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix);
+    void d_write_offs(const int32_t *mat, int32_t row_off, int32_t col_off,
+                      int32_t m_matrix, int32_t n_matrix);
+    void d_write_tc_tnn(const int32_t *mat, int32_t row_off, int32_t col_off,
+                        int32_t m_matrix, int32_t n_matrix, bool offset);
+    int32_t diff_row_sum(uint32_t row, uint32_t num_seg, int32_t n_begin,
+                         int32_t n_end) const;
+    const int32_t *region_sum_w(int32_t row_off, int32_t col_off,
+                                int32_t m_matrix, int32_t n_matrix,
+                                uint32_t num_seg);
+    void a_write_p_m(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                     int32_t n_end);
+    void a_write_p_m_bnn_tnn(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                             int32_t n_end);
+    void a_write_p(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                   int32_t n_end);
+    void a_write_p_bnn(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                       int32_t n_end);
+    // Programmed weights for d_write (copied first if shared)
+    ProgrammedWeights &mutable_weights();
+    void build_sparse(uint32_t rows, int32_t n_matrix);
+    void update_sparse();
+    // Sparse pattern for the digital/analog MVM of the cell rows [0, rows)
+    // and the columns [col_off, col_off + n_matrix) (nullptr: dense)
+    const SparsePattern *sparse_d(uint32_t rows, int32_t col_off,
+                                  int32_t n_matrix) const {
+        return (sparse_d_ && sparse_covers(rows, col_off, n_matrix))
+                   ? &weights_->sparse
+                   : nullptr;
+    }
+    const SparsePattern *sparse_a(uint32_t rows, int32_t col_off,
+                                  int32_t n_matrix) const {
+        return (sparse_a_ && sparse_covers(rows, col_off, n_matrix))
+                   ? &weights_->sparse
+                   : nullptr;
+    }
+    bool sparse_covers(uint32_t rows, int32_t col_off, int32_t n_matrix) const;
+    template <typename F>
+    static void for_each_col(uint32_t row, int32_t n_matrix,
+                             const SparsePattern *sparse, F &&f);
+    float row_current(const float *i, const int32_t *v, int32_t num_v,
+                      uint32_t row, int32_t n_matrix,
+                      const SparsePattern *sparse) const;
+    template <typename F> void dispatch_kernel(F &&f) const;
+    uint32_t kernel_num_segments() const;
 
+    const Config &cfg_;
     bool is_diff_weight_mapping_;
+    // Backing memory of the analog state planes (nullptr: heap)
+    std::unique_ptr<StorageArena> storage_;
 
     // Parameters for the digital crossbar
-    std::vector<std::vector<int32_t>> gd_p_;
-    std::vector<std::vector<int32_t>> gd_m_;
     std::vector<uint32_t> shift_;
-    std::vector<int32_t> sum_w_;
+    std::shared_ptr<ProgrammedWeights> weights_; // Shared with replicas
+    std::vector<int16_t> packed_vec_; // Input of the packed GEMV
+    std::vector<int32_t> region_sum_w_; // sum_w of a column range
+    bool sparse_d_;
+    bool sparse_a_;
 
     // Parameters for the analog crossbar
-    std::vector<std::vector<float>> ia_p_;
-    std::vector<std::vector<float>> ia_m_;
+    Plane<float> ia_p_;
+    Plane<float> ia_m_;
     std::vector<float> i_step_size_;
     int num_segments_;
     float i_mm_;
-    const std::unique_ptr<ADC> adc_;
+    std::unique_ptr<ADC> adc_;
+    // Active input columns of a bit plane
+    std::vector<uint32_t> active_cols_;
 
   private:
+    void init_analog();
+
     // State variability
     float add_gaussian_noise(float mean);
+    std::mt19937 gen_; // Own generator: mappers can run on different threads
     std::normal_distribution<float> hrs_var_;
     std::normal_distribution<float> lrs_var_;
 };
 
+// Call f(n) for all columns n of a row (sparse == nullptr) or only for the
+// non-HRS cells of the sparse pattern
+template <typename F>
+void Mapper::for_each_col(uint32_t row, int32_t n_matrix,
+                          const SparsePattern *sparse, F &&f) {
+    if (sparse) {
+        for (const uint32_t *n = sparse->row_begin(row);
+             n != sparse->row_end(row); ++n) {
+            f(*n);
+        }
+    } else {
+        for (size_t n = 0; n < n_matrix; ++n) {
+            f(n);
+        }
+    }
+}
+
+// Select the compile-time specialized bit-serial kernel for the current config.
+// Specializations exist for I_BIT = 8 and 1, 2, 4 or 8 weight segments, e.g.,
+// SPLIT = {8}, {4, 4}, {2, 2, 2, 2} or {1, 1, 1, 1, 1, 1, 1, 1}.
+// f is called with (NUM_SEG, I_BIT) as std::integral_constant. (0, 0) selects
+// the generic kernel.
+template <typename F> void Mapper::dispatch_kernel(F &&f) const {
+    using ibit_8 = std::integral_constant<uint32_t, 8>;
+    switch (kernel_num_segments()) {
+    case 1:
+        f(std::integral_constant<uint32_t, 1>{}, ibit_8{});
+        break;
+    case 2:
+        f(std::integral_constant<uint32_t, 2>{}, ibit_8{});
+        break;
+    case 4:
+        f(std::integral_constant<uint32_t, 4>{}, ibit_8{});
+        break;
+    case 8:
+        f(std::integral_constant<uint32_t, 8>{}, ibit_8{});
+        break;
+    default:
+        f(std::integral_constant<uint32_t, 0>{},
+          std::integral_constant<uint32_t, 0>{});
+    }
+}
+
 } // namespace nq
 
 #endif
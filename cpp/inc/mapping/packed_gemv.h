@@ -0,0 +1,57 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef PACKED_GEMV_H
+#define PACKED_GEMV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "helper/storage.h"
+
+namespace nq {
+
+// Packed int16 copy of the weight segments for the digital MVM.
+// Each row is zero-padded to a multiple of LANES values and the dot products
+// use pairwise int16 multiply-adds (AVX-512 VNNI, AVX2 or SSE2) with a
+// portable fallback. Segment values and inputs must fit into int16.
+class PackedGemv {
+  public:
+    PackedGemv(uint32_t rows, uint32_t cols);
+    PackedGemv(const PackedGemv &) = default;
+    virtual ~PackedGemv() = default;
+
+    // Largest number of bits (unsigned) of weight segments and inputs
+    static constexpr uint32_t MAX_BITS = 15;
+
+    // mat[r][n] = g_a[r][n] - g_b[r][n] for the rows [r_begin, r_end) and
+    // columns [n_begin, n_end)
+    void pack(const Plane<int32_t> &g_a, const Plane<int32_t> &g_b,
+              uint32_t r_begin, uint32_t r_end, int32_t n_begin,
+              int32_t n_end);
+    // mat[r][n] = g[r][n]
+    void pack(const Plane<int32_t> &g, uint32_t r_begin, uint32_t r_end,
+              int32_t n_begin, int32_t n_end);
+    // tmp[r] += sum_n mat[row_off + r][col_off + n] * vec[n], vec_buf:
+    // stride() int16 values of the caller (the packed matrix can be shared by
+    // concurrent callers)
+    void gemv(int32_t *tmp, const int32_t *vec, uint32_t row_off,
+              uint32_t rows, int32_t col_off, int32_t n_matrix,
+              int16_t *vec_buf) const;
+    size_t stride() const { return stride_; }
+
+  private:
+    static constexpr uint32_t LANES = 32;
+
+    size_t stride_; // Number of int16 values per packed row
+    std::vector<int16_t> mat_;
+};
+
+} // namespace nq
+
+#endif
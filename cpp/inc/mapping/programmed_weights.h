@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef PROGRAMMED_WEIGHTS_H
+#define PROGRAMMED_WEIGHTS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "helper/storage.h"
+#include "mapping/packed_gemv.h"
+#include "mapping/sparse_pattern.h"
+
+namespace nq {
+
+// Programmed (digital) weights of a mapper and the data derived from them.
+// Crossbar replicas share one instance, a mapper copies it before a write
+// if it is shared (copy-on-write). The analog state (currents, read
+// disturb) is not part of it.
+struct ProgrammedWeights {
+    // rows x cols planes (rows = M * number of weight segments), sum_w of m
+    // rows, packed: create the packed copy of the weight segments
+    ProgrammedWeights(uint32_t rows, uint32_t cols, uint32_t m, bool packed,
+                      std::unique_ptr<StorageArena> storage);
+    ProgrammedWeights(const ProgrammedWeights &) = delete;
+
+    // Deep copy (with own storage of the same type)
+    std::unique_ptr<ProgrammedWeights>
+    clone(std::unique_ptr<StorageArena> storage) const;
+
+    // Backing memory of the planes (nullptr: heap), declared first
+    std::unique_ptr<StorageArena> storage;
+    Plane<int32_t> gd_p;
+    Plane<int32_t> gd_m;
+    std::vector<int32_t> sum_w;
+    // Extent of the written matrix: rows and columns of the last full write,
+    // grown by region writes outside of it
+    int32_t m_written;
+    int32_t n_written;
+    // Packed copy of the weight segments (INT mappings, nullptr if the
+    // segments or inputs do not fit into int16)
+    std::unique_ptr<PackedGemv> packed;
+    // Non-HRS cells, built in d_write if the density is below the threshold
+    SparsePattern sparse;
+    float sparse_density;
+    std::vector<uint32_t> sparse_dims; // {rows, n_matrix} of the last build
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef SPARSE_PATTERN_H
+#define SPARSE_PATTERN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "helper/storage.h"
+
+namespace nq {
+
+// Compressed sparse row (CSR) pattern of the non-HRS cells of the crossbar.
+// A column n of row r is part of the pattern if g_a[r][n] != 0 or
+// g_b[r][n] != 0. All other cells are in HRS.
+class SparsePattern {
+  public:
+    SparsePattern() = default;
+    SparsePattern(const SparsePattern &) = default;
+    SparsePattern &operator=(const SparsePattern &) = default;
+    virtual ~SparsePattern() = default;
+
+    // Returns the density (fraction of non-HRS cells)
+    float build(const Plane<int32_t> &g_a, const Plane<int32_t> &g_b,
+                uint32_t rows, int32_t n_matrix);
+
+    // Column indices of row r: [row_begin(r), row_end(r))
+    const uint32_t *row_begin(uint32_t r) const {
+        return col_idx_.data() + row_ptr_[r];
+    }
+    const uint32_t *row_end(uint32_t r) const {
+        return col_idx_.data() + row_ptr_[r + 1];
+    }
+
+  private:
+    std::vector<uint32_t> row_ptr_;
+    std::vector<uint32_t> col_idx_;
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef CONV2D_H
+#define CONV2D_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "network/layer.h"
+
+namespace nq {
+
+struct Conv2dParams {
+    int32_t in_channels;
+    int32_t in_h;
+    int32_t in_w;
+    int32_t out_channels;
+    int32_t kernel_h;
+    int32_t kernel_w;
+    int32_t stride_h;
+    int32_t stride_w;
+    int32_t pad_h; // Zero padding on both sides
+    int32_t pad_w;
+    int32_t dilation_h;
+    int32_t dilation_w;
+    int32_t groups; // groups = in_channels: depthwise convolution
+
+    int32_t out_h() const {
+        return (in_h + 2 * pad_h - dilation_h * (kernel_h - 1) - 1) / stride_h +
+               1;
+    }
+    int32_t out_w() const {
+        return (in_w + 2 * pad_w - dilation_w * (kernel_w - 1) - 1) / stride_w +
+               1;
+    }
+    // Inputs of one output channel (one row of the weight matrix)
+    int32_t patch_size() const {
+        return (in_channels / groups) * kernel_h * kernel_w;
+    }
+    bool is_valid() const;
+};
+
+// 2D convolution (inputs and outputs in CHW layout, weights in
+// OC x IC/groups x KH x KW layout) lowered onto crossbar MVMs with an
+// implicit im2col: the patch of an output pixel is gathered right before its
+// MVM (with a scheduler, the patches of PIXELS_PER_TASK pixels per thread),
+// the patch matrix of a sample is never materialized.
+// Groups that fit into one tile (e.g., depthwise channels) share the tile as
+// a block-diagonal matrix, the patches of all groups of a tile are processed
+// in one MVM.
+class Conv2dLayer : public Layer {
+  public:
+    Conv2dLayer(const Config &cfg, const std::string &name,
+                const int32_t *weights, const Conv2dParams &params,
+                std::vector<int32_t> bias, std::vector<float> scale,
+                int32_t out_min, int32_t out_max);
+
+    void forward(const int32_t *in, int32_t batch, int32_t *acc,
+                 TaskScheduler *scheduler) override;
+
+  private:
+    static constexpr int32_t PIXELS_PER_TASK = 16;
+
+    // Groups [first_group, first_group + num_groups) mapped to one matrix
+    struct GroupBlock {
+        int32_t first_group;
+        int32_t num_groups;
+        std::unique_ptr<TiledMatrix> weights;
+    };
+
+    void gather_patch(const int32_t *in, int32_t oy, int32_t ox,
+                      const GroupBlock &block, int32_t *patch) const;
+
+    const Conv2dParams params_;
+    std::vector<GroupBlock> blocks_;
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef LAYER_H
+#define LAYER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helper/task_scheduler.h"
+#include "xbar/crossbar.h"
+
+namespace nq {
+
+// Weight matrix (m x n, row-major) distributed to crossbar tiles of at most
+// cfg.M x cfg.N. Each tile has its own crossbar and is programmed once.
+class TiledMatrix {
+  public:
+    TiledMatrix(const Config &cfg, const int32_t *mat, int32_t m_matrix,
+                int32_t n_matrix);
+    TiledMatrix(const TiledMatrix &) = delete;
+    virtual ~TiledMatrix() = default;
+
+    // res (m) += mat * vec (n)
+    void mvm(int32_t *res, const int32_t *vec);
+    // res (batch x m) += mat * vec (batch x n)
+    // With a scheduler, the tiles run in parallel: one task per tile and
+    // chunk of the batch. The chunks of a tile run in order (the crossbar
+    // state, e.g., read disturb, evolves like in the sequential case), the
+    // partial sums of the tiles are reduced in tile order.
+    void mvm_batch(int32_t *res, const int32_t *vec, int32_t batch,
+                   TaskScheduler *scheduler);
+    int32_t rows() const { return m_matrix_; }
+    int32_t cols() const { return n_matrix_; }
+    size_t num_tiles() const { return tiles_.size(); }
+
+  private:
+    struct Tile {
+        int32_t row; // First row/column of the tile in the matrix
+        int32_t col;
+        int32_t m;
+        int32_t n;
+        std::vector<int32_t> mat; // Weights of the tile (m x n)
+        std::unique_ptr<Crossbar> xbar;
+    };
+
+    int32_t m_matrix_;
+    int32_t n_matrix_;
+    std::vector<Tile> tiles_;
+};
+
+// Quantized layer. The integer accumulators of the crossbar MVMs (plus bias)
+// are scaled per output channel and either requantized to the input range of
+// the next layer or returned as logits:
+//   out = clamp(round((acc + bias[c]) * scale[c]), out_min, out_max)
+//   logit = (acc + bias[c]) * scale[c]
+// Outputs are stored channel-major (channel c covers channel_size outputs).
+class Layer {
+  public:
+    Layer(const std::string &name, int32_t in_size, int32_t out_size,
+          int32_t out_channels, std::vector<int32_t> bias,
+          std::vector<float> scale, int32_t out_min, int32_t out_max);
+    Layer(const Layer &) = delete;
+    virtual ~Layer() = default;
+
+    // acc (batch x out_size) += layer(in (batch x in_size))
+    // scheduler: nullptr or scheduler for tile-level parallelism
+    virtual void forward(const int32_t *in, int32_t batch, int32_t *acc,
+                         TaskScheduler *scheduler) = 0;
+    void requantize(const int32_t *acc, int32_t batch, int32_t *out) const;
+    void dequantize(const int32_t *acc, int32_t batch, float *out) const;
+
+    const std::string &name() const { return name_; }
+    int32_t in_size() const { return in_size_; }
+    int32_t out_size() const { return out_size_; }
+
+  protected:
+    const std::string name_;
+    const int32_t in_size_;
+    const int32_t out_size_;
+
+  private:
+    float channel_scale(int32_t i) const;
+    int32_t channel_bias(int32_t i) const;
+
+    const int32_t channel_size_;
+    const std::vector<int32_t> bias_; // Empty or one per output channel
+    const std::vector<float> scale_;  // One or one per output channel
+    const int32_t out_min_;
+    const int32_t out_max_;
+};
+
+// Fully connected layer: weights out_features x in_features (row-major)
+class DenseLayer : public Layer {
+  public:
+    DenseLayer(const Config &cfg, const std::string &name,
+               const int32_t *weights, int32_t out_features,
+               int32_t in_features, std::vector<int32_t> bias,
+               std::vector<float> scale, int32_t out_min, int32_t out_max);
+
+    void forward(const int32_t *in, int32_t batch, int32_t *acc,
+                 TaskScheduler *scheduler) override;
+
+  private:
+    TiledMatrix weights_;
+};
+
+} // namespace nq
+
+#endif
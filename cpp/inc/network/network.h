@@ -0,0 +1,78 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helper/config.h"
+#include "helper/task_scheduler.h"
+#include "network/conv2d.h"
+#include "network/layer.h"
+#include "network/pipeline.h"
+
+namespace nq {
+
+// Sequence of layers executed end to end on a batch of inputs. The network
+// uses its own copy of the config at creation time, later config updates do
+// not affect it.
+class Network {
+  public:
+    explicit Network(const Config &cfg);
+    Network(const Network &) = delete;
+    virtual ~Network();
+
+    // bias: nullptr or out_features values
+    // scale: num_scales = 1 or out_features values
+    bool add_dense(const std::string &name, const int32_t *weights,
+                   int32_t out_features, int32_t in_features,
+                   const int32_t *bias, const float *scale, int32_t num_scales,
+                   int32_t out_min, int32_t out_max);
+    // weights: out_channels x in_channels / groups x kernel_h x kernel_w
+    // bias: nullptr or out_channels values
+    // scale: num_scales = 1 or out_channels values
+    bool add_conv2d(const std::string &name, const int32_t *weights,
+                    const Conv2dParams &params, const int32_t *bias,
+                    const float *scale, int32_t num_scales, int32_t out_min,
+                    int32_t out_max);
+    // Threads for the tiles of a layer in run() (1: sequential, 0: one per
+    // hardware thread). The results do not depend on the number of threads.
+    void set_num_threads(uint32_t num_threads);
+    // inputs: batch x in_size(), logits: batch x out_size()
+    bool run(const int32_t *inputs, int32_t batch, float *logits);
+    // Same results as run(), the inputs are streamed through a pipeline with
+    // one thread per layer (queue_depth: inputs buffered between two stages)
+    bool run_pipelined(const int32_t *inputs, int32_t batch, float *logits,
+                       size_t queue_depth);
+    // Stage statistics of the last run_pipelined()
+    const std::vector<StageStats> &stage_stats() const { return stage_stats_; }
+
+    size_t num_layers() const { return layers_.size(); }
+    int32_t in_size() const;
+    int32_t out_size() const;
+
+  private:
+    bool check_inputs(const int32_t *inputs, int32_t batch,
+                      const float *logits) const;
+    bool check_layer(const std::string &name, int32_t in_size,
+                     int32_t out_channels, const float *scale,
+                     int32_t num_scales, int32_t out_min,
+                     int32_t out_max) const;
+
+    std::unique_ptr<Config> cfg_;
+    std::vector<std::unique_ptr<Layer>> layers_;
+    std::vector<StageStats> stage_stats_;
+    std::unique_ptr<TaskScheduler> scheduler_; // nullptr: sequential
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helper/spsc_queue.h"
+#include "network/layer.h"
+
+namespace nq {
+
+struct StageStats {
+    std::string name; // Layer name
+    uint64_t items;   // Processed inputs
+    double busy_s;    // Time spent in the crossbar MVMs of the stage
+    double occupancy; // busy_s / runtime of the pipeline
+};
+
+// Pipelined execution of a layer sequence: one stage (worker thread) per
+// layer, connected by bounded lock-free queues. While a stage processes input
+// i, the previous stage already processes input i + 1, like layers mapped to
+// separate arrays of a CIM accelerator. Each layer is only accessed by its
+// own stage.
+class Pipeline {
+  public:
+    Pipeline(std::vector<std::unique_ptr<Layer>> &layers, size_t queue_depth);
+    Pipeline(const Pipeline &) = delete;
+    virtual ~Pipeline() = default;
+
+    // inputs: batch x in_size of the first layer
+    // logits: batch x out_size of the last layer
+    void run(const int32_t *inputs, int32_t batch, float *logits);
+    const std::vector<StageStats> &stats() const { return stats_; }
+
+  private:
+    struct Activation {
+        int32_t sample; // -1: end of the stream
+        std::vector<int32_t> data;
+    };
+
+    void run_stage(size_t stage, float *logits);
+
+    std::vector<std::unique_ptr<Layer>> &layers_;
+    // queues_[l]: inputs of stage l
+    std::vector<std::unique_ptr<SpscQueue<Activation>>> queues_;
+    std::vector<StageStats> stats_;
+};
+
+} // namespace nq
+
+#endif
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "helper/config.h"
+#include "helper/trace.h"
+#include "nlohmann/json.hpp"
+
+namespace nq {
+
+struct SweepResult {
+    std::string delta; // Config delta of the point (JSON)
+    bool valid;        // false if the workload does not fit the crossbar
+    uint64_t cpy_ops;
+    uint64_t mvm_ops;
+    uint64_t mismatches; // MVMs whose result differs from the trace
+    double mean_abs_err; // Mean absolute error per MVM output
+    int64_t max_abs_err; // Max. absolute error of an MVM output
+    double time_s;       // Runtime of the replay
+};
+
+// Evaluates config deltas (design points) on a recorded workload. Each point
+// is replayed on its own crossbar with its own config (base config + delta).
+// The points are distributed to a pool of worker threads. The decoded
+// workload is shared by all workers. The first matrix of the workload is
+// programmed once per crossbar geometry (keys of ConfigUpdate::REBUILD and
+// sparse_threshold), the points start with a replica of this crossbar
+// instead of writing it again. time_s does not include the programming.
+class SweepEngine {
+  public:
+    SweepEngine(const Config &base, std::vector<TraceRecord> workload);
+    SweepEngine(const SweepEngine &) = delete;
+    virtual ~SweepEngine() = default;
+
+    // num_threads = 0: one thread per hardware thread
+    std::vector<SweepResult> run(const std::vector<nlohmann::json> &deltas,
+                                 uint32_t num_threads) const;
+    static bool write_csv(const std::string &path,
+                          const std::vector<SweepResult> &results);
+    // Number of crossbars programmed with the first matrix so far (one per
+    // geometry of the valid points)
+    size_t num_programmed() const;
+
+  private:
+    // Crossbar of a geometry programmed with the first matrix
+    struct ProgrammedXbar {
+        std::unique_ptr<Config> cfg; // Outlives xbar (declared first)
+        std::once_flag once;
+        std::unique_ptr<Crossbar> xbar;
+    };
+
+    SweepResult run_point(const nlohmann::json &delta) const;
+    const Crossbar &programmed_xbar(const nlohmann::json &delta) const;
+
+    const Config &base_;
+    const std::vector<TraceRecord> workload_;
+    int32_t max_m_; // Largest matrix of the workload
+    int32_t max_n_;
+    // Index: fingerprint of the geometry config (base config + REBUILD keys)
+    mutable std::map<uint64_t, std::unique_ptr<ProgrammedXbar>> programmed_;
+    mutable std::mutex programmed_mutex_;
+};
+
+} // namespace nq
+
+#endif
@@ -10,37 +10,109 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "adc/adc_schedule.h"
+#include "helper/definitions.h"
 #include "mapping/mapper.h"
 #include "xbar/read_disturb.h"
 
 namespace nq {
 
+class Config;
+
+// The crossbar reads its parameters from cfg, which must outlive the
+// crossbar. Independent crossbars can be used from different threads.
+// The cell currents of written cells are programmed on the next analog
+// access (MVM, get_ia_*, save), so the getters are not thread-safe either.
 class Crossbar {
   public:
-    Crossbar();
+    explicit Crossbar(const Config &cfg);
     Crossbar(const Crossbar &) = delete;
     virtual ~Crossbar();
 
+    // Apply a config update without recreating the crossbar (update below
+    // ConfigUpdate::REBUILD), the programmed weights are kept
+    void reconfigure(ConfigUpdate update);
+    // Crossbar with the same config that shares the programmed weights
+    // (copy-on-write) and has its own analog state, as if the weights were
+    // written to a new crossbar once (e.g., for Monte Carlo runs)
+    std::unique_ptr<Crossbar> replicate() const;
+    // Replica with cfg instead, which may differ from the config of the
+    // crossbar only in keys below ConfigUpdate::REBUILD (e.g., ADC or cell
+    // parameters). cfg must outlive the replica.
+    std::unique_ptr<Crossbar> replicate(const Config &cfg) const;
     void write(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
+    // Reprogram only the cells of the rows [row_off, row_off + m_matrix) and
+    // columns [col_off, col_off + n_matrix) with mat (m_matrix x n_matrix)
+    void write_region(const int32_t *mat, int32_t row_off, int32_t col_off,
+                      int32_t m_matrix, int32_t n_matrix);
+    // Write mat to a free region of the crossbar (first fit) and return its
+    // offsets, false if no region is large enough. Placed matrices share the
+    // crossbar until the next write, which removes all placements.
+    bool place(const int32_t *mat, int32_t m_matrix, int32_t n_matrix,
+               int32_t *row_off, int32_t *col_off);
+    // Row gating: with rows (num_rows ascending row indices of the matrix),
+    // only these rows are activated and converted, res of the other rows is
+    // unchanged
     void mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-             int32_t m_matrix, int32_t n_matrix);
-    const std::vector<std::vector<int32_t>> &get_gd_p() const;
-    const std::vector<std::vector<int32_t>> &get_gd_m() const;
-    const std::vector<std::vector<float>> &get_ia_p() const;
-    const std::vector<std::vector<float>> &get_ia_m() const;
-    const std::vector<std::vector<uint64_t>> &get_cycles_p() const;
-    const std::vector<std::vector<uint64_t>> &get_cycles_m() const;
-    const std::vector<std::vector<uint64_t>> &get_consecutive_reads_p() const;
-    const std::vector<std::vector<uint64_t>> &get_consecutive_reads_m() const;
+             int32_t m_matrix, int32_t n_matrix, const int32_t *rows = nullptr,
+             int32_t num_rows = 0);
+    // res += W * vec for the matrix W (m_matrix x n_matrix) at the offsets,
+    // e.g., of place. Only the rows and columns of W are activated.
+    void mvm_region(int32_t *res, const int32_t *vec, int32_t row_off,
+                    int32_t col_off, int32_t m_matrix, int32_t n_matrix,
+                    const int32_t *rows = nullptr, int32_t num_rows = 0);
+    const Plane<int32_t> &get_gd_p() const;
+    const Plane<int32_t> &get_gd_m() const;
+    const Plane<float> &get_ia_p() const;
+    const Plane<float> &get_ia_m() const;
+    const Plane<uint64_t> &get_cycles_p() const;
+    const Plane<uint64_t> &get_cycles_m() const;
+    const Plane<uint64_t> &get_consecutive_reads_p() const;
+    const Plane<uint64_t> &get_consecutive_reads_m() const;
     const uint64_t get_write_xbar_counter() const;
     const uint64_t get_mvm_counter() const;
     const uint64_t get_read_num() const;
     const uint64_t get_refresh_xbar_counter() const;
     const uint64_t get_refresh_cell_counter() const;
     const bool get_rd_run_out_of_bounds() const;
+    const ADCTelemetry *get_adc_telemetry() const;
+    void reset_adc_telemetry();
+    // Conversion cycles of the shared ADCs (nullptr if adc_share is 0)
+    const ADCSchedule *get_adc_schedule() const;
+    void reset_adc_schedule();
+    // Number of crossbars sharing the programmed weights (replicas)
+    long get_weight_users() const;
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
 
   private:
+    // Crossbar with the mapper (e.g., a replica of another mapper)
+    Crossbar(const Config &cfg, std::unique_ptr<Mapper> mapper);
+
+    struct Region {
+        int32_t row_off;
+        int32_t col_off;
+        int32_t m_matrix;
+        int32_t n_matrix;
+    };
+
+    void init_adc_model();
+    std::vector<uint32_t> geometry() const;
+    bool is_digital_equivalent() const;
+    bool is_free(int32_t row_off, int32_t col_off, int32_t m_matrix,
+                 int32_t n_matrix) const;
+    void program_cells(const int32_t *mat, int32_t row_off, int32_t col_off,
+                       int32_t m_matrix, int32_t n_matrix, bool full);
+    void mark_dirty(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                    int32_t n_end);
+    void program_analog() const;
+    void schedule_adc(const ADCBatchCount &before, int32_t row_off,
+                      int32_t m_matrix, const int32_t *rows, int32_t num_rows);
+
+    const Config &cfg_;
     std::unique_ptr<Mapper> mapper_;
     uint64_t write_xbar_counter_; // Number of write function calls
     uint64_t mvm_counter_;        // Number of MVM function calls
@@ -49,6 +121,14 @@ class Crossbar {
                                        // (without a write in between)
     uint64_t refresh_xbar_counter_;    // Number of complete crossbar refreshes
     uint64_t refresh_cell_counter_;    // Number of single-cell refreshes
+    bool digital_shortcut_; // Ideal analog config -> use the digital MVM
+    std::unique_ptr<ADCSchedule> adc_schedule_;
+    // Per matrix row: columns [begin, end) written since the currents were
+    // programmed (a_write is deferred until the next analog access)
+    mutable std::vector<int32_t> dirty_begin_;
+    mutable std::vector<int32_t> dirty_end_;
+    mutable bool dirty_;
+    std::vector<Region> placed_; // Regions of the placed matrices
 };
 
 } // namespace nq
@@ -0,0 +1,94 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#ifndef CROSSBAR_POOL_H
+#define CROSSBAR_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "helper/config.h"
+#include "xbar/crossbar.h"
+
+namespace nq {
+
+// Crossbars owned by a pool of worker threads for asynchronous MVMs. Each
+// crossbar is bound to one worker, so its MVMs run in submission order (the
+// crossbar state, e.g., read disturb, is the same as for synchronous calls),
+// while MVMs on crossbars of different workers run in parallel.
+class CrossbarPool {
+  public:
+    // num_threads: worker threads (0: one per hardware thread)
+    explicit CrossbarPool(uint32_t num_threads);
+    CrossbarPool(const CrossbarPool &) = delete;
+    // Waits for all submitted MVMs
+    virtual ~CrossbarPool();
+
+    // Creates a crossbar with a copy of the current config (CFG) and
+    // programs mat, returns the handle
+    int32_t add_xbar(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
+    // Creates a replica of the crossbar (Crossbar::replicate) bound to the
+    // next worker, returns the handle
+    int32_t replicate_xbar(int32_t handle);
+    // Number of crossbars sharing the programmed weights of the crossbar
+    // (Crossbar::get_weight_users), -1 for an invalid handle
+    long get_weight_users(int32_t handle);
+    // Waits for the MVMs of the crossbar and destroys it
+    bool remove_xbar(int32_t handle);
+    // Queues res += mat * vec on the crossbar, returns the ticket or -1. vec
+    // is copied, res must stay valid until the MVM is done.
+    int64_t submit_mvm(int32_t handle, int32_t *res, const int32_t *vec,
+                       int32_t m_matrix, int32_t n_matrix);
+    // Blocks until the MVM of the ticket is done (false: unknown ticket)
+    bool wait(int64_t ticket);
+    bool is_done(int64_t ticket);
+
+  private:
+    struct Slot {
+        std::shared_ptr<Config> cfg; // Outlives xbar (declared first)
+        std::unique_ptr<Crossbar> xbar;
+        std::shared_ptr<const std::vector<int32_t>> mat; // Shared by replicas
+        int32_t m_matrix;
+        int32_t n_matrix;
+        uint32_t worker;
+        uint64_t pending; // Submitted MVMs not finished yet
+    };
+
+    struct Job {
+        int64_t ticket;
+        Slot *slot;
+        int32_t *res;
+        std::vector<int32_t> vec;
+    };
+
+    struct Worker {
+        std::deque<Job> jobs;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    void worker_loop(uint32_t id);
+    Slot *get_slot(int32_t handle);
+
+    std::vector<std::unique_ptr<Slot>> slots_; // Index: handle
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unordered_set<int64_t> pending_tickets_;
+    int64_t next_ticket_;
+    bool stop_;
+    std::mutex mutex_; // Guards the jobs, tickets and pending counters
+    std::condition_variable done_cv_;
+};
+
+} // namespace nq
+
+#endif
@@ -9,10 +9,16 @@
 #define READ_DISTURB_H
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "helper/snapshot.h"
+#include "helper/storage.h"
+
 namespace nq {
 
+class Config;
+
 /*
 This read disturb model is based on a paper written by Cheng-Min Jiang et al.:
 "An Analytical Model of Read-Disturb Failure Time in a Post-Cycling Resistive
@@ -20,14 +26,14 @@ Switching Memory", Link: https://ieeexplore.ieee.org/document/9580480
 */
 class ReadDisturb {
   public:
-    ReadDisturb(const float V_read);
+    ReadDisturb(const Config &cfg, const float V_read);
     ReadDisturb(const ReadDisturb &) = delete;
     virtual ~ReadDisturb() = default;
 
-    const std::vector<std::vector<uint64_t>> &get_cycles_p() const;
-    const std::vector<std::vector<uint64_t>> &get_cycles_m() const;
-    const std::vector<std::vector<uint64_t>> &get_consecutive_reads_p() const;
-    const std::vector<std::vector<uint64_t>> &get_consecutive_reads_m() const;
+    const Plane<uint64_t> &get_cycles_p() const;
+    const Plane<uint64_t> &get_cycles_m() const;
+    const Plane<uint64_t> &get_consecutive_reads_p() const;
+    const Plane<uint64_t> &get_consecutive_reads_m() const;
     void update_cycles(const std::vector<std::vector<bool>> &update_p,
                        const std::vector<std::vector<bool>> &update_m);
     float calc_G0_scaling_factor(const uint64_t read_num,
@@ -35,20 +41,28 @@ class ReadDisturb {
     float calc_transition_time(const uint64_t N_cycles) const;
     void update_cycle_p(int m, int n, uint64_t cycles);
     void update_cycle_m(int m, int n, uint64_t cycles);
-    void update_consecutive_reads(int32_t m_matrix, int32_t n_matrix);
+    // Count one read of the cells in the rows [row_off, row_off + m_matrix)
+    // and columns [col_off, col_off + n_matrix)
+    void update_consecutive_reads(int32_t row_off, int32_t col_off,
+                                  int32_t m_matrix, int32_t n_matrix);
     void reset_all_consecutive_reads();
     void reset_consecutive_reads_p(int m, int n);
     void reset_consecutive_reads_m(int m, int n);
     const bool get_run_out_of_bounds() const;
+    float get_V_read() const { return V_read_; }
+    void save(SnapshotWriter &snapshot) const;
+    bool load(const SnapshotReader &snapshot);
 
   private:
     float calc_exp_tt(const float V_read) const;
     float calc_p(const float V_read) const;
 
-    std::vector<std::vector<uint64_t>> cycles_p_;
-    std::vector<std::vector<uint64_t>> cycles_m_;
-    std::vector<std::vector<uint64_t>> consecutive_reads_p_;
-    std::vector<std::vector<uint64_t>> consecutive_reads_m_;
+    const Config &cfg_;
+    std::unique_ptr<StorageArena> storage_; // nullptr: heap
+    Plane<uint64_t> cycles_p_;
+    Plane<uint64_t> cycles_m_;
+    Plane<uint64_t> consecutive_reads_p_;
+    Plane<uint64_t> consecutive_reads_m_;
 
     const float t0_;
     const float fitting_param_; // Obtained from papers graphs
@@ -8,15 +8,80 @@
 #include "adc/adc.h"
 #include "helper/config.h"
 #include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#define ADC_AVX
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#define ADC_SSE4_1
+#include <smmintrin.h>
+#endif
 
 namespace nq {
 
-ADC::ADC(const float min_curr, const float max_curr) :
-    min_adc_curr_(min_curr), max_adc_curr_(max_curr) {}
+ADC::ADC(const Config &cfg, const float min_curr, const float max_curr) :
+    min_adc_curr_(min_curr), max_adc_curr_(max_curr),
+    clip_min_(cfg.alpha * min_curr), clip_max_(cfg.alpha * max_curr),
+    batch_count_{0, 0} {}
 
 float ADC::clip(const float current) const {
-    return std::min(std::max(current, CFG.alpha * min_adc_curr_),
-                    CFG.alpha * max_adc_curr_);
+    return std::min(std::max(current, clip_min_), clip_max_);
+}
+
+void ADC::convert(const float *in, float *out, size_t n) const {
+    record(in, n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = analog_digital_conversion(in[i]);
+    }
+}
+
+// Clipping and mid-tread quantization:
+// out[i] = round(clip(in[i]) * inv_step_size) * step_size
+// Rounding is half away from zero (std::round) in all code paths.
+void ADC::quantize(const float *in, float *out, size_t n, float step_size,
+                   float inv_step_size) const {
+    size_t i = 0;
+#if defined(ADC_AVX)
+    const __m256 lo = _mm256_set1_ps(clip_min_);
+    const __m256 hi = _mm256_set1_ps(clip_max_);
+    const __m256 inv = _mm256_set1_ps(inv_step_size);
+    const __m256 step = _mm256_set1_ps(step_size);
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(in + i);
+        x = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+        __m256 q = _mm256_mul_ps(x, inv);
+        __m256 t = _mm256_round_ps(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m256 frac = _mm256_andnot_ps(sign_mask, _mm256_sub_ps(q, t));
+        __m256 inc = _mm256_or_ps(_mm256_and_ps(q, sign_mask), one);
+        inc = _mm256_and_ps(_mm256_cmp_ps(frac, half, _CMP_GE_OQ), inc);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_add_ps(t, inc), step));
+    }
+#elif defined(ADC_SSE4_1)
+    const __m128 lo = _mm_set1_ps(clip_min_);
+    const __m128 hi = _mm_set1_ps(clip_max_);
+    const __m128 inv = _mm_set1_ps(inv_step_size);
+    const __m128 step = _mm_set1_ps(step_size);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(in + i);
+        x = _mm_min_ps(_mm_max_ps(x, lo), hi);
+        __m128 q = _mm_mul_ps(x, inv);
+        __m128 t = _mm_round_ps(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m128 frac = _mm_andnot_ps(sign_mask, _mm_sub_ps(q, t));
+        __m128 inc = _mm_or_ps(_mm_and_ps(q, sign_mask), one);
+        inc = _mm_and_ps(_mm_cmpge_ps(frac, half), inc);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(t, inc), step));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::round(clip(in[i]) * inv_step_size) * step_size;
+    }
 }
 
 } // namespace nq
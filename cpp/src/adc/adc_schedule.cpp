@@ -0,0 +1,96 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "adc/adc_schedule.h"
+
+#include <algorithm>
+
+namespace nq {
+
+ADCSchedule::ADCSchedule(uint32_t num_rows, uint32_t share, ADCMuxOrder order,
+                         float latency) :
+    num_rows_(num_rows), share_(std::max(share, 1u)), order_(order),
+    latency_(latency), lines_per_row_(1), num_adcs_(0), num_ranges_(0),
+    range_begin_(0), range_end_(0) {
+    begin_mvm(1);
+    reset();
+}
+
+void ADCSchedule::reset() {
+    cycles_ = 0;
+    total_cycles_ = 0;
+    num_mvms_ = 0;
+}
+
+void ADCSchedule::begin_mvm(uint32_t lines_per_row) {
+    lines_per_row_ = std::max(lines_per_row, 1u);
+    num_adcs_ = (num_rows_ * lines_per_row_ + share_ - 1) / share_;
+    num_ranges_ = 0;
+}
+
+// SEQUENTIAL: ADC k converts the lines [k * share, (k + 1) * share),
+// INTERLEAVED: the lines k, k + num_adcs, k + 2 * num_adcs, ...
+uint32_t ADCSchedule::adc_of(uint32_t line) const {
+    return (order_ == ADCMuxOrder::SEQUENTIAL) ? line / share_
+                                               : line % num_adcs_;
+}
+
+// Largest number of lines of [begin, end) of one ADC
+uint32_t ADCSchedule::range_load(uint32_t begin, uint32_t end) const {
+    const uint32_t size = end - begin;
+    if (order_ == ADCMuxOrder::INTERLEAVED) {
+        return (size + num_adcs_ - 1) / num_adcs_;
+    }
+    const uint32_t first = begin / share_;
+    const uint32_t last = (end - 1) / share_;
+    if (first == last) {
+        return size;
+    }
+    if (last - first >= 2) {
+        return share_; // A block of the range in between
+    }
+    return std::max((first + 1) * share_ - begin, end - last * share_);
+}
+
+void ADCSchedule::count_lines(uint32_t begin, uint32_t end) {
+    for (uint32_t line = begin; line < end; ++line) {
+        load_[adc_of(line)]++;
+    }
+}
+
+void ADCSchedule::add_rows(uint32_t begin, uint32_t end) {
+    if (begin >= end) {
+        return;
+    }
+    const uint32_t line_begin = begin * lines_per_row_;
+    const uint32_t line_end = end * lines_per_row_;
+    if (num_ranges_ == 0) {
+        range_begin_ = line_begin;
+        range_end_ = line_end;
+    } else {
+        if (num_ranges_ == 1) {
+            load_.assign(num_adcs_, 0);
+            count_lines(range_begin_, range_end_);
+        }
+        count_lines(line_begin, line_end);
+    }
+    num_ranges_++;
+}
+
+void ADCSchedule::end_mvm(uint64_t rounds) {
+    uint64_t load = 0;
+    if (num_ranges_ == 1) {
+        load = range_load(range_begin_, range_end_);
+    } else if (num_ranges_ > 1) {
+        load = *std::max_element(load_.begin(), load_.end());
+    }
+    cycles_ = rounds * load;
+    total_cycles_ += cycles_;
+    num_mvms_++;
+}
+
+} // namespace nq
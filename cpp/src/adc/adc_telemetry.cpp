@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "adc/adc_telemetry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nq {
+
+ADCTelemetry::ADCTelemetry(float clip_min, float clip_max,
+                           float inv_step_size) :
+    clip_min_(clip_min), clip_max_(clip_max), inv_step_size_(inv_step_size),
+    code_offset_(0), code_shift_(0) {
+    if (inv_step_size_ != 0.0) {
+        // Same rounding as ADC::quantize
+        code_offset_ =
+            static_cast<int64_t>(std::round(clip_min_ * inv_step_size_));
+        const int64_t code_max =
+            static_cast<int64_t>(std::round(clip_max_ * inv_step_size_));
+        const uint64_t max_idx = code_max - code_offset_;
+        while ((max_idx >> code_shift_) >= (1ULL << MAX_HIST_BITS)) {
+            ++code_shift_;
+        }
+        hist_.resize((max_idx >> code_shift_) + 1);
+    }
+    reset();
+}
+
+void ADCTelemetry::reset() {
+    std::fill(hist_.begin(), hist_.end(), 0);
+    clip_low_ = 0;
+    clip_high_ = 0;
+    num_conversions_ = 0;
+    min_current_ = std::numeric_limits<float>::max();
+    max_current_ = std::numeric_limits<float>::lowest();
+}
+
+void ADCTelemetry::record(const float *in, size_t n) {
+    float min_curr = min_current_;
+    float max_curr = max_current_;
+    for (size_t i = 0; i < n; ++i) {
+        const float current = in[i];
+        min_curr = std::min(min_curr, current);
+        max_curr = std::max(max_curr, current);
+        clip_low_ += (current < clip_min_);
+        clip_high_ += (current > clip_max_);
+    }
+    min_current_ = min_curr;
+    max_current_ = max_curr;
+    num_conversions_ += n;
+
+    if (hist_.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const float clip_current =
+            std::min(std::max(in[i], clip_min_), clip_max_);
+        const int64_t code =
+            static_cast<int64_t>(std::round(clip_current * inv_step_size_));
+        ++hist_[static_cast<uint64_t>(code - code_offset_) >> code_shift_];
+    }
+}
+
+} // namespace nq
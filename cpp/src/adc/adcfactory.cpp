@@ -12,14 +12,14 @@
 
 namespace nq {
 
-std::unique_ptr<ADC> ADCFactory::createADC(ADCType type) {
+std::unique_ptr<ADC> ADCFactory::createADC(ADCType type, const Config &cfg) {
     switch (type) {
     case ADCType::INF_ADC:
-        return std::make_unique<InfADC>();
+        return std::make_unique<InfADC>(cfg);
     case ADCType::SYM_RANGE_ADC:
-        return std::make_unique<SymADC>();
+        return std::make_unique<SymADC>(cfg);
     case ADCType::POS_RANGE_ONLY_ADC:
-        return std::make_unique<PosADC>();
+        return std::make_unique<PosADC>(cfg);
         return nullptr;
     default:
         return nullptr;
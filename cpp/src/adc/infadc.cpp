@@ -6,15 +6,27 @@
  * found in the root directory of this source tree.                           *
  ******************************************************************************/
 #include "adc/infadc.h"
+#include <algorithm>
 
 namespace nq {
 
-InfADC::InfADC() :
-    ADC(std::numeric_limits<float>::lowest(),
-        std::numeric_limits<float>::max()) {}
+InfADC::InfADC(const Config &cfg) :
+    ADC(cfg, std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::max()) {
+    if (cfg.adc_telemetry) {
+        telemetry_ = std::make_unique<ADCTelemetry>(clip_min_, clip_max_, 0.0);
+    }
+}
 
 float InfADC::analog_digital_conversion(const float current) const {
     return current;
 }
 
+void InfADC::convert(const float *in, float *out, size_t n) const {
+    record(in, n);
+    if (in != out) {
+        std::copy(in, in + n, out);
+    }
+}
+
 } // namespace nq
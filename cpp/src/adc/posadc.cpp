@@ -11,19 +11,30 @@
 
 namespace nq {
 
-PosADC::PosADC() :
-    ADC(get_min_curr(), get_max_curr()),
-    step_size_((max_adc_curr_ * CFG.alpha) /
-               ((std::pow(2, CFG.resolution)) - 1)) {}
+PosADC::PosADC(const Config &cfg) :
+    ADC(cfg, get_min_curr(cfg), get_max_curr(cfg)),
+    step_size_((max_adc_curr_ * cfg.alpha) /
+               ((std::pow(2, cfg.resolution)) - 1)),
+    inv_step_size_(1.0f / step_size_) {
+    if (cfg.adc_telemetry) {
+        telemetry_ = std::make_unique<ADCTelemetry>(clip_min_, clip_max_,
+                                                    inv_step_size_);
+    }
+}
 
-float PosADC::get_max_curr() const { return CFG.N * CFG.LRS; }
+float PosADC::get_max_curr(const Config &cfg) { return cfg.N * cfg.LRS; }
 
-float PosADC::get_min_curr() const { return 0.0; }
+float PosADC::get_min_curr(const Config &cfg) { return 0.0; }
 
 float PosADC::analog_digital_conversion(const float current) const {
     float clip_current = clip(current);
-    float adc_res = round(clip_current / step_size_) * step_size_;
+    float adc_res = std::round(clip_current * inv_step_size_) * step_size_;
     return adc_res;
 }
 
+void PosADC::convert(const float *in, float *out, size_t n) const {
+    record(in, n);
+    quantize(in, out, n, step_size_, inv_step_size_);
+}
+
 } // namespace nq
@@ -6,64 +6,106 @@
  * found in the root directory of this source tree.                           *
  ******************************************************************************/
 #include "helper/config.h"
+#include <map>
 #include <optional>
 
 namespace nq {
 
+namespace {
+
+// FNV-1a hash of the binary config, verbose does not affect the simulation
+uint64_t hash_cfg(nlohmann::json cfg_data) {
+    cfg_data.erase("verbose");
+    uint64_t hash = 14695981039346656037ULL;
+    for (const uint8_t byte : nlohmann::json::to_msgpack(cfg_data)) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
 Config::~Config() {}
 
-Config::Config() {}
+Config::Config() : fingerprint_(0) {}
 
 Config &Config::get_cfg() {
     static Config instance;
     return instance;
 }
 
+std::unique_ptr<Config> Config::create() {
+    return std::unique_ptr<Config>(new Config());
+}
+
+std::unique_ptr<Config> Config::clone() const {
+    std::unique_ptr<Config> cfg = create();
+    cfg->cfg_data_ = cfg_data_;
+    if (!cfg->apply_config()) {
+        return nullptr;
+    }
+    return cfg;
+}
+
 // Read parameter from JSON config file
-// If the parameter is not found, return the default value if provided.
-// Otherwise: exit with an error message.
+// If the parameter is not found (or null), return the default value if
+// provided. Otherwise: exit with an error message.
 template <typename T>
 T getConfigValue(const nlohmann::json &cfg, const std::string &key,
                  std::optional<T> default_value = std::nullopt) {
-    try {
-        return cfg.at(key).get<T>();
-    } catch (const std::exception &e) {
-        if (!default_value.has_value()) {
-            std::cerr << "Parameter '" << key
-                      << "' not found in config. Add it to the config or "
-                         "specify a default value.\n";
-            std::exit(EXIT_FAILURE);
-        }
-        return default_value.value();
+    const auto it = cfg.find(key);
+    if ((it != cfg.end()) && !it->is_null()) {
+        return it->get<T>();
     }
+    if (!default_value.has_value()) {
+        std::cerr << "Parameter '" << key
+                  << "' not found in config. Add it to the config or "
+                     "specify a default value.\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return default_value.value();
 }
 
 bool Config::load_cfg(const char *cfg_file = "") {
     if (strcmp(cfg_file, "") == 0) {
-        const char *cfg_file = std::getenv("CFG_FILE");
+        cfg_file = std::getenv("CFG_FILE");
         if (cfg_file == nullptr) {
             return false;
         }
-        std::ifstream file_stream(cfg_file);
-        if (!file_stream.is_open()) {
-            std::cerr << "Could not open config file!";
-            std::exit(EXIT_FAILURE);
-        }
-        file_stream >> cfg_data_;
-        file_stream.close();
-    } else {
-        std::ifstream file_stream(cfg_file);
-        if (!file_stream.is_open()) {
-            std::cerr << "Could not open config file!";
-            std::exit(EXIT_FAILURE);
+    }
+
+    std::ifstream file_stream(cfg_file, std::ios::binary);
+    if (!file_stream.is_open()) {
+        std::cerr << "Could not open config file!";
+        std::exit(EXIT_FAILURE);
+    }
+    try {
+        // JSON configs start with '{', binary configs with a MessagePack map
+        if ((file_stream >> std::ws).peek() == '{') {
+            file_stream >> cfg_data_;
+        } else {
+            cfg_data_ = nlohmann::json::from_msgpack(file_stream);
         }
-        file_stream >> cfg_data_;
-        file_stream.close();
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid config file: " << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
     }
+    file_stream.close();
 
     return apply_config();
 }
 
+bool Config::save_cfg(const char *cfg_file) const {
+    std::ofstream file_stream(cfg_file, std::ios::binary | std::ios::trunc);
+    if (!file_stream.is_open()) {
+        std::cerr << "Could not open config file: " << cfg_file << std::endl;
+        return false;
+    }
+    nlohmann::json::to_msgpack(cfg_data_, file_stream);
+    return static_cast<bool>(file_stream);
+}
+
 bool Config::apply_config() {
     try {
         M = getConfigValue<uint32_t>(cfg_data_, "M");
@@ -190,6 +232,10 @@ bool Config::apply_config() {
             HRS_NOISE = getConfigValue<float>(cfg_data_, "HRS_NOISE");
             LRS_NOISE = getConfigValue<float>(cfg_data_, "LRS_NOISE");
 
+            // Digital MVM for ideal analog configs (results are identical)
+            digital_shortcut =
+                getConfigValue<bool>(cfg_data_, "digital_shortcut", true);
+
             // Read disturb simulation
             read_disturb =
                 getConfigValue<bool>(cfg_data_, "read_disturb", false);
@@ -286,6 +332,43 @@ bool Config::apply_config() {
 
         verbose = getConfigValue<bool>(cfg_data_, "verbose");
 
+        sparse_threshold =
+            getConfigValue<float>(cfg_data_, "sparse_threshold", 0.4f);
+
+        adc_telemetry = getConfigValue<bool>(cfg_data_, "adc_telemetry", false);
+
+        adc_share = getConfigValue<int32_t>(cfg_data_, "adc_share", 0);
+        adc_latency = getConfigValue<float>(cfg_data_, "adc_latency", 1.0f);
+        if ((adc_share < 0) || (adc_latency < 0.0)) {
+            std::cerr << "adc_share and adc_latency must be >= 0." << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        std::string adc_mux_order_name = getConfigValue<std::string>(
+            cfg_data_, "adc_mux_order", "SEQUENTIAL");
+        if (adc_mux_order_name == "SEQUENTIAL") {
+            adc_mux_order = ADCMuxOrder::SEQUENTIAL;
+        } else if (adc_mux_order_name == "INTERLEAVED") {
+            adc_mux_order = ADCMuxOrder::INTERLEAVED;
+        } else {
+            std::cerr << "Unkown ADC mux order." << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        std::string storage_name =
+            getConfigValue<std::string>(cfg_data_, "storage", "HEAP");
+        if (storage_name == "HEAP") {
+            storage = StorageType::HEAP;
+        } else if (storage_name == "MMAP") {
+            storage = StorageType::MMAP;
+        } else if (storage_name == "HUGEPAGE") {
+            storage = StorageType::HUGEPAGE;
+        } else {
+            std::cerr << "Unkown storage type." << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        storage_dir = getConfigValue<std::string>(cfg_data_, "storage_dir", "");
+
+        fingerprint_ = hash_cfg(cfg_data_);
         return true;
     } catch (const std::exception &e) {
         std::cerr << "Error applying configuration: " << e.what() << std::endl;
@@ -293,35 +376,80 @@ bool Config::apply_config() {
     }
 }
 
-bool Config::is_int_mapping(const MappingMode &mode) {
+bool Config::is_int_mapping(const MappingMode &mode) const {
     return mode_to_type.at(mode) == MappingType::INT;
 }
 
-bool Config::is_bnn_mapping(const MappingMode &mode) {
+bool Config::is_bnn_mapping(const MappingMode &mode) const {
     return mode_to_type.at(mode) == MappingType::BNN;
 }
 
-bool Config::is_tnn_mapping(const MappingMode &mode) {
+bool Config::is_tnn_mapping(const MappingMode &mode) const {
     return mode_to_type.at(mode) == MappingType::TNN;
 }
 
-bool Config::update_cfg(const char *json_string, bool *recreate_xbar,
-                        const std::vector<std::string> &recreation_keys) {
+ConfigUpdate Config::key_update(const std::string &key) {
+    static const std::map<std::string, ConfigUpdate> updates = {
+        {"M", ConfigUpdate::REBUILD},
+        {"N", ConfigUpdate::REBUILD},
+        {"SPLIT", ConfigUpdate::REBUILD},
+        {"W_BIT", ConfigUpdate::REBUILD},
+        {"I_BIT", ConfigUpdate::REBUILD},
+        {"m_mode", ConfigUpdate::REBUILD},
+        {"digital_only", ConfigUpdate::REBUILD},
+        {"storage", ConfigUpdate::REBUILD},
+        {"storage_dir", ConfigUpdate::REBUILD},
+        {"HRS", ConfigUpdate::ANALOG},
+        {"LRS", ConfigUpdate::ANALOG},
+        {"HRS_NOISE", ConfigUpdate::ANALOG},
+        {"LRS_NOISE", ConfigUpdate::ANALOG},
+        {"read_disturb", ConfigUpdate::ANALOG},
+        {"V_read", ConfigUpdate::ANALOG},
+        {"t_read", ConfigUpdate::ANALOG},
+        {"read_disturb_update_freq", ConfigUpdate::ANALOG},
+        {"read_disturb_mitigation_strategy", ConfigUpdate::ANALOG},
+        {"read_disturb_mitigation_fp", ConfigUpdate::ANALOG},
+        {"read_disturb_update_tolerance", ConfigUpdate::ANALOG},
+        {"adc_type", ConfigUpdate::ADC},
+        {"alpha", ConfigUpdate::ADC},
+        {"resolution", ConfigUpdate::ADC},
+        {"adc_telemetry", ConfigUpdate::ADC},
+        {"adc_share", ConfigUpdate::ADC},
+        {"adc_latency", ConfigUpdate::ADC},
+        {"adc_mux_order", ConfigUpdate::ADC},
+        {"digital_shortcut", ConfigUpdate::ADC}};
+    auto it = updates.find(key);
+    return (it != updates.end()) ? it->second : ConfigUpdate::NONE;
+}
+
+bool Config::update_cfg(const char *json_string, ConfigUpdate *update) {
     if (!json_string) {
         std::cerr << "Error: JSON string is null." << std::endl;
         return false;
     }
 
+    nlohmann::json updates;
     try {
-        // Parse the JSON string
-        nlohmann::json updates = nlohmann::json::parse(json_string);
+        updates = nlohmann::json::parse(json_string);
+    } catch (const nlohmann::json::parse_error &e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return update_cfg(updates, update);
+}
 
+bool Config::update_cfg(const nlohmann::json &updates, ConfigUpdate *update) {
+    if (!updates.is_object()) {
+        std::cerr << "Error: Config update is not a JSON object." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    try {
         // Track if configuration was actually modified
         bool config_modified = false;
 
-        // Initialize recreate_xbar flag if provided
-        if (recreate_xbar) {
-            *recreate_xbar = false;
+        if (update) {
+            *update = ConfigUpdate::NONE;
         }
 
         // Apply updates to the configuration
@@ -349,11 +477,9 @@ bool Config::update_cfg(const char *json_string, bool *recreate_xbar,
                 cfg_data_[key] = new_value;
                 config_modified = true;
 
-                // Check if this key requires crossbar recreation
-                if (recreate_xbar &&
-                    std::find(recreation_keys.begin(), recreation_keys.end(),
-                              key) != recreation_keys.end()) {
-                    *recreate_xbar = true;
+                // Keep the most severe update of all changed keys
+                if (update) {
+                    *update = std::max(*update, key_update(key));
                 }
 
                 if (verbose) {
@@ -369,9 +495,6 @@ bool Config::update_cfg(const char *json_string, bool *recreate_xbar,
         }
 
         return false;
-    } catch (const nlohmann::json::parse_error &e) {
-        std::cerr << "JSON parse error: " << e.what() << std::endl;
-        std::exit(EXIT_FAILURE);
     } catch (const std::exception &e) {
         std::cerr << "Error updating config from JSON: " << e.what()
                   << std::endl;
@@ -0,0 +1,158 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "helper/snapshot.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nq {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = "ACSSNAP";
+
+uint64_t align_up(uint64_t offset) {
+    return (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+} // namespace
+
+void SnapshotWriter::add_section(
+    const char *name, SnapshotType dtype, uint32_t elem_size, uint64_t rows,
+    uint64_t cols, std::function<void(std::ofstream &)> write_data) {
+    SnapshotSection section = {};
+    std::strncpy(section.name, name, sizeof(section.name) - 1);
+    section.dtype = dtype;
+    section.elem_size = elem_size;
+    section.rows = rows;
+    section.cols = cols;
+    sections_.push_back(section);
+    write_data_.push_back(std::move(write_data));
+}
+
+bool SnapshotWriter::write(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot open snapshot file: " << path << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.num_sections = sections_.size();
+
+    std::vector<SnapshotSection> sections = sections_;
+    uint64_t offset =
+        sizeof(SnapshotHeader) + sections.size() * sizeof(SnapshotSection);
+    for (auto &section : sections) {
+        offset = align_up(offset);
+        section.offset = offset;
+        offset += section.rows * section.cols * section.elem_size;
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(sections.data()),
+              sections.size() * sizeof(SnapshotSection));
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const std::vector<char> padding(sections[i].offset - out.tellp(), 0);
+        out.write(padding.data(), padding.size());
+        write_data_[i](out);
+    }
+
+    if (!out) {
+        std::cerr << "Writing snapshot file failed: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+SnapshotReader::SnapshotReader(const std::string &path) :
+    data_(nullptr), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open snapshot file: " << path << std::endl;
+        return;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) ||
+        (static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader))) {
+        std::cerr << "Invalid snapshot file: " << path << std::endl;
+        close(fd);
+        return;
+    }
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Cannot map snapshot file: " << path << std::endl;
+        return;
+    }
+    data_ = static_cast<const uint8_t *>(addr);
+    size_ = st.st_size;
+
+    SnapshotHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    const uint64_t table_end =
+        sizeof(header) +
+        static_cast<uint64_t>(header.num_sections) * sizeof(SnapshotSection);
+    if ((std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) !=
+         0) ||
+        (header.version != SNAPSHOT_VERSION) || (table_end > size_)) {
+        std::cerr << "Invalid snapshot file or unsupported version: " << path
+                  << std::endl;
+        munmap(const_cast<uint8_t *>(data_), size_);
+        data_ = nullptr;
+        return;
+    }
+    sections_.resize(header.num_sections);
+    std::memcpy(sections_.data(), data_ + sizeof(header),
+                sections_.size() * sizeof(SnapshotSection));
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t *>(data_), size_);
+    }
+}
+
+const SnapshotSection *SnapshotReader::find(const char *name) const {
+    for (const auto &section : sections_) {
+        if (std::strncmp(section.name, name, sizeof(section.name)) == 0) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+const void *SnapshotReader::section_data(const char *name, SnapshotType dtype,
+                                         uint64_t rows, uint64_t cols) const {
+    const SnapshotSection *section = find(name);
+    if (section == nullptr) {
+        std::cerr << "Snapshot section '" << name << "' not found."
+                  << std::endl;
+        return nullptr;
+    }
+    if ((section->dtype != dtype) || (section->rows != rows) ||
+        (section->cols != cols)) {
+        std::cerr << "Snapshot section '" << name
+                  << "' does not match the crossbar config." << std::endl;
+        return nullptr;
+    }
+    if (section->offset + rows * cols * section->elem_size > size_) {
+        std::cerr << "Snapshot section '" << name << "' is truncated."
+                  << std::endl;
+        return nullptr;
+    }
+    return data_ + section->offset;
+}
+
+} // namespace nq
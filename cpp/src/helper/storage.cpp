@@ -0,0 +1,98 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "helper/storage.h"
+#include "helper/config.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace nq {
+
+StorageArena::StorageArena(StorageType type, const std::string &dir) :
+    type_(type), fd_(-1), file_size_(0), cur_(nullptr), left_(0) {
+    if (type_ == StorageType::MMAP) {
+        std::string path =
+            (dir.empty() ? std::filesystem::temp_directory_path().string()
+                         : dir) +
+            "/acs_storage_XXXXXX";
+        fd_ = mkstemp(path.data());
+        if (fd_ < 0) {
+            std::cerr << "Cannot create storage file in: " << path
+                      << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        // The file is removed as soon as the arena is destroyed
+        unlink(path.c_str());
+    }
+}
+
+StorageArena::~StorageArena() {
+    for (const auto &chunk : chunks_) {
+        munmap(chunk.first, chunk.second);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+std::unique_ptr<StorageArena>
+StorageArena::create_from_config(const Config &cfg) {
+    if (cfg.storage == StorageType::HEAP) {
+        return nullptr;
+    }
+    return std::make_unique<StorageArena>(cfg.storage, cfg.storage_dir);
+}
+
+void StorageArena::map_chunk(size_t min_bytes) {
+    const size_t page = sysconf(_SC_PAGESIZE);
+    size_t size = std::max(min_bytes, CHUNK_SIZE);
+    size = (size + page - 1) / page * page;
+
+    void *addr = MAP_FAILED;
+    if (type_ == StorageType::MMAP) {
+        // Grow the (sparse) backing file and map the new part
+        if (ftruncate(fd_, file_size_ + size) == 0) {
+            addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                        file_size_);
+            file_size_ += size;
+        }
+    } else {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+        if (addr != MAP_FAILED) {
+            madvise(addr, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    if (addr == MAP_FAILED) {
+        std::cerr << "Mapping crossbar storage failed." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    chunks_.emplace_back(addr, size);
+    cur_ = static_cast<uint8_t *>(addr);
+    left_ = size;
+}
+
+void *StorageArena::do_allocate(size_t bytes, size_t alignment) {
+    size_t pad = (alignment - reinterpret_cast<uintptr_t>(cur_) % alignment) %
+                 alignment;
+    if (cur_ == nullptr || pad + bytes > left_) {
+        map_chunk(bytes);
+        pad = 0;
+    }
+    void *p = cur_ + pad;
+    cur_ += pad + bytes;
+    left_ -= pad + bytes;
+    return p;
+}
+
+} // namespace nq
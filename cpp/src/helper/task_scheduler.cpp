@@ -0,0 +1,167 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "helper/task_scheduler.h"
+
+#include <algorithm>
+
+namespace nq {
+
+namespace {
+
+// Worker of the current thread. A thread can be a worker of several
+// schedulers (nested run() calls), the index is only valid for scheduler.
+struct WorkerIdentity {
+    const TaskScheduler *scheduler;
+    uint32_t id;
+};
+thread_local WorkerIdentity current_worker = {nullptr, 0};
+
+} // namespace
+
+TaskScheduler::TaskScheduler(uint32_t num_threads) :
+    pending_(0), queued_(0), generation_(0), active_(0), stop_(false) {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (uint32_t id = 0; id < num_threads; ++id) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t id = 1; id < num_threads; ++id) {
+        threads_.emplace_back(&TaskScheduler::worker_loop, this, id);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        stop_ = true;
+    }
+    run_cv_.notify_all();
+    for (auto &t : threads_) {
+        t.join();
+    }
+}
+
+void TaskScheduler::run(std::vector<Task> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    // Distribute the initial tasks round-robin
+    pending_ = tasks.size();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        push_task(i % workers_.size(), std::move(tasks[i]));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        active_ = threads_.size();
+        generation_++;
+    }
+    run_cv_.notify_all();
+
+    const WorkerIdentity prev = current_worker;
+    current_worker = {this, 0};
+    execute(0);
+    current_worker = prev;
+
+    // All threads must leave this run before the next one can start
+    std::unique_lock<std::mutex> lock(run_mutex_);
+    done_cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+void TaskScheduler::spawn(Task task) {
+    // Count first: the spawning task is still pending, so pending_ > 0
+    pending_++;
+    const bool own = (current_worker.scheduler == this);
+    push_task(own ? current_worker.id : 0, std::move(task));
+}
+
+void TaskScheduler::push_task(uint32_t id, Task task) {
+    {
+        Worker &worker = *workers_[id];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    {
+        // Under the lock: a waiting worker cannot miss the new task
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        queued_++;
+    }
+    wait_cv_.notify_one();
+}
+
+void TaskScheduler::worker_loop(uint32_t id) {
+    current_worker = {this, id};
+    uint64_t generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(run_mutex_);
+            run_cv_.wait(lock,
+                         [&] { return stop_ || (generation_ != generation); });
+            if (stop_) {
+                return;
+            }
+            generation = generation_;
+        }
+
+        execute(id);
+
+        {
+            std::lock_guard<std::mutex> lock(run_mutex_);
+            active_--;
+        }
+        done_cv_.notify_one();
+    }
+}
+
+void TaskScheduler::execute(uint32_t id) {
+    Task task;
+    while (pending_.load() > 0) {
+        if (next_task(id, task)) {
+            task();
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            if (--pending_ == 0) {
+                wait_cv_.notify_all();
+            }
+        } else {
+            // Tasks can still be spawned by the running tasks
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cv_.wait(lock, [this] {
+                return (queued_.load() > 0) || (pending_.load() == 0);
+            });
+        }
+    }
+}
+
+bool TaskScheduler::next_task(uint32_t id, Task &task) {
+    {
+        Worker &own = *workers_[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < workers_.size(); ++k) {
+        Worker &victim = *workers_[(id + k) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace nq
@@ -0,0 +1,230 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "helper/trace.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace nq {
+
+namespace {
+
+const char TRACE_MAGIC[8] = {'A', 'C', 'S', 'T', 'R', 'A', 'C', 'E'};
+
+template <typename T> void append(std::vector<char> &buf, const T &val) {
+    const char *p = reinterpret_cast<const char *>(&val);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+template <typename T> void unpack(const char *src, int32_t *dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        T val;
+        std::memcpy(&val, src + i * sizeof(T), sizeof(T));
+        dst[i] = val;
+    }
+}
+
+} // namespace
+
+bool TraceWriter::open(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.close();
+    }
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        std::cerr << "Cannot open trace file: " << path << std::endl;
+        return false;
+    }
+    out_.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out_.write(reinterpret_cast<const char *>(&TRACE_VERSION),
+               sizeof(TRACE_VERSION));
+    return true;
+}
+
+void TraceWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+void TraceWriter::record_cpy(const int32_t *mat, int32_t m_matrix,
+                             int32_t n_matrix, const char *name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_head(TraceOp::CPY, name, m_matrix, n_matrix);
+    write_array(mat, static_cast<size_t>(m_matrix) * n_matrix);
+    out_.write(buf_.data(), buf_.size());
+}
+
+void TraceWriter::record_mvm(const int32_t *res_in, const int32_t *res_out,
+                             const int32_t *vec, int32_t m_matrix,
+                             int32_t n_matrix, const char *name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_head(TraceOp::MVM, name, m_matrix, n_matrix);
+    write_array(vec, n_matrix);
+    write_array(res_in, m_matrix);
+    write_array(res_out, m_matrix);
+    out_.write(buf_.data(), buf_.size());
+}
+
+void TraceWriter::write_head(TraceOp op, const char *name, int32_t m_matrix,
+                             int32_t n_matrix) {
+    const uint16_t name_len =
+        (name == nullptr) ? 0 : std::min<size_t>(std::strlen(name), UINT16_MAX);
+    buf_.clear();
+    append(buf_, static_cast<uint8_t>(op));
+    append(buf_, name_len);
+    buf_.insert(buf_.end(), name, name + name_len);
+    append(buf_, m_matrix);
+    append(buf_, n_matrix);
+}
+
+void TraceWriter::write_array(const int32_t *data, size_t size) {
+    int32_t min_val = 0;
+    int32_t max_val = 0;
+    if (size > 0) {
+        const auto min_max = std::minmax_element(data, data + size);
+        min_val = *min_max.first;
+        max_val = *min_max.second;
+    }
+
+    uint8_t width = sizeof(int32_t);
+    if ((min_val >= INT8_MIN) && (max_val <= INT8_MAX)) {
+        width = sizeof(int8_t);
+    } else if ((min_val >= INT16_MIN) && (max_val <= INT16_MAX)) {
+        width = sizeof(int16_t);
+    }
+    append(buf_, width);
+
+    for (size_t i = 0; i < size; ++i) {
+        if (width == sizeof(int8_t)) {
+            append(buf_, static_cast<int8_t>(data[i]));
+        } else if (width == sizeof(int16_t)) {
+            append(buf_, static_cast<int16_t>(data[i]));
+        } else {
+            append(buf_, data[i]);
+        }
+    }
+}
+
+TraceReader::TraceReader(const std::string &path) :
+    in_(path, std::ios::binary), valid_(false), failed_(false) {
+    if (!in_) {
+        std::cerr << "Cannot open trace file: " << path << std::endl;
+        return;
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    uint32_t version = 0;
+    in_.read(magic, sizeof(magic));
+    in_.read(reinterpret_cast<char *>(&version), sizeof(version));
+    if (!in_ || (std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) ||
+        (version != TRACE_VERSION)) {
+        std::cerr << "Invalid trace file or unsupported version: " << path
+                  << std::endl;
+        return;
+    }
+    valid_ = true;
+}
+
+bool TraceReader::next(TraceRecord &rec) {
+    if (!valid_ || failed_) {
+        return false;
+    }
+
+    uint8_t op;
+    uint16_t name_len;
+    if (!in_.read(reinterpret_cast<char *>(&op), sizeof(op))) {
+        // Regular end of the trace
+        return false;
+    }
+    in_.read(reinterpret_cast<char *>(&name_len), sizeof(name_len));
+    rec.name.resize(name_len);
+    in_.read(&rec.name[0], name_len);
+    in_.read(reinterpret_cast<char *>(&rec.m_matrix), sizeof(rec.m_matrix));
+    in_.read(reinterpret_cast<char *>(&rec.n_matrix), sizeof(rec.n_matrix));
+    if (!in_ || (op > static_cast<uint8_t>(TraceOp::MVM)) ||
+        (rec.m_matrix < 0) || (rec.n_matrix < 0)) {
+        failed_ = true;
+        return false;
+    }
+    rec.op = static_cast<TraceOp>(op);
+
+    // The arrays of the other op are cleared, rec can be reused
+    bool ok;
+    if (rec.op == TraceOp::CPY) {
+        const size_t size = static_cast<size_t>(rec.m_matrix) * rec.n_matrix;
+        rec.vec.clear();
+        rec.res_in.clear();
+        rec.res_out.clear();
+        ok = read_array(rec.mat, size);
+    } else {
+        rec.mat.clear();
+        ok = read_array(rec.vec, rec.n_matrix) &&
+             read_array(rec.res_in, rec.m_matrix) &&
+             read_array(rec.res_out, rec.m_matrix);
+    }
+    failed_ = !ok;
+    return ok;
+}
+
+bool TraceReader::read_array(std::vector<int32_t> &data, size_t size) {
+    uint8_t width;
+    if (!in_.read(reinterpret_cast<char *>(&width), sizeof(width)) ||
+        ((width != sizeof(int8_t)) && (width != sizeof(int16_t)) &&
+         (width != sizeof(int32_t)))) {
+        return false;
+    }
+    buf_.resize(size * width);
+    if (!in_.read(buf_.data(), buf_.size())) {
+        return false;
+    }
+
+    data.resize(size);
+    if (width == sizeof(int8_t)) {
+        unpack<int8_t>(buf_.data(), data.data(), size);
+    } else if (width == sizeof(int16_t)) {
+        unpack<int16_t>(buf_.data(), data.data(), size);
+    } else {
+        unpack<int32_t>(buf_.data(), data.data(), size);
+    }
+    return true;
+}
+
+bool read_trace(const std::string &path, std::vector<TraceRecord> &records) {
+    TraceReader reader(path);
+    if (!reader.is_open()) {
+        return false;
+    }
+    for (TraceRecord rec; reader.next(rec); rec = TraceRecord()) {
+        records.push_back(std::move(rec));
+    }
+    if (reader.failed()) {
+        std::cerr << "Trace is truncated or corrupted after " << records.size()
+                  << " records: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+TraceWriter &get_trace_recorder() {
+    static TraceWriter recorder;
+    static std::once_flag env_checked;
+    std::call_once(env_checked, [] {
+        const char *path = std::getenv("ACS_TRACE");
+        if ((path != nullptr) && (path[0] != '\0')) {
+            recorder.open(path);
+        }
+    });
+    return recorder;
+}
+
+} // namespace nq
@@ -7,6 +7,9 @@
  ******************************************************************************/
 #include "stdio.h"
 #include <iostream>
+#include <vector>
+
+#include "helper/trace.h"
 
 // Typedef for the function pointer for the C - Python conversion
 typedef int32_t (*mvm_c_to_py_funcptr)(int32_t *res, int32_t *vec, int32_t *mat,
@@ -30,6 +33,16 @@ extern "C" void set_cpy_python_cb(cpy_c_to_py_funcptr cb) { cpy_c_to_py = cb; }
 
 extern "C" void update_config(const char *json_config) { return; }
 
+extern "C" int32_t start_trace(const char *path) {
+    if (path == nullptr) {
+        std::cerr << "Error: Trace path is null." << std::endl;
+        return -1;
+    }
+    return nq::get_trace_recorder().open(path) ? 0 : -1;
+}
+
+extern "C" void stop_trace() { nq::get_trace_recorder().close(); }
+
 extern "C" int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
                            int32_t m_matrix, int32_t n_matrix,
                            const char *l_name = "Unknown") {
@@ -51,6 +64,11 @@ extern "C" int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
     std::cout << "Max value: " << max_val << ", Min value: " << min_val
               << std::endl;
 #endif
+    nq::TraceWriter &trace = nq::get_trace_recorder();
+    std::vector<int32_t> res_in;
+    if (trace.is_open()) {
+        res_in.assign(res, res + m_matrix);
+    }
     static int warning_done = 0;
     if (!mvm_c_to_py) {
         if (!warning_done) {
@@ -64,9 +82,16 @@ extern "C" int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
                 res[m] += mat[n_matrix * m + n] * vec[n];
             }
         }
+        if (trace.is_open()) {
+            trace.record_mvm(res_in.data(), res, vec, m_matrix, n_matrix,
+                             l_name);
+        }
         return 0;
     }
     (*mvm_c_to_py)(res, vec, mat, m_matrix, n_matrix);
+    if (trace.is_open()) {
+        trace.record_mvm(res_in.data(), res, vec, m_matrix, n_matrix, l_name);
+    }
 #ifdef DEBUG_MODE
 // Find max and min values in the result vector
 #include <cstdint>
@@ -109,6 +134,10 @@ extern "C" int32_t cpy_mtrx(int32_t *mat, int32_t m_matrix, int32_t n_matrix,
     std::cout << "Max value: " << max_val << ", Min value: " << min_val
               << std::endl;
 #endif
+    nq::TraceWriter &trace = nq::get_trace_recorder();
+    if (trace.is_open()) {
+        trace.record_cpy(mat, m_matrix, n_matrix, l_name);
+    }
     static int warning_done = 0;
     if (!cpy_c_to_py) {
         if (!warning_done) {
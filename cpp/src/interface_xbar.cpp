@@ -5,14 +5,21 @@
  * This is work is licensed under the terms described in the LICENSE file     *
  * found in the root directory of this source tree.                           *
  ******************************************************************************/
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <stdexcept>
 #include <stdio.h>
+#include <utility>
 #include <vector>
 
 #include "helper/config.h"
+#include "helper/trace.h"
+#include "network/network.h"
+#include "sweep/sweep.h"
+#include "xbar/crossbar_pool.h"
 
 #ifndef EXPORT_API
 #define EXPORT_API __attribute__((visibility("default")))
@@ -21,7 +28,13 @@
 /********************** Global variables **********************/
 bool cfg_loaded = nq::Config::get_cfg().load_cfg("");
 std::unique_ptr<nq::Crossbar> xbar =
-    (cfg_loaded) ? std::make_unique<nq::Crossbar>() : nullptr;
+    (cfg_loaded) ? std::make_unique<nq::Crossbar>(CFG) : nullptr;
+// Networks created with net_create(), the handle is the index
+std::vector<std::unique_ptr<nq::Network>> networks;
+// Crossbars for asynchronous MVMs, created with the first xbar_create()
+std::unique_ptr<nq::CrossbarPool> xbar_pool;
+// Crossbars programmed by the last run_sweep() (one per geometry)
+size_t sweep_num_programmed = 0;
 
 /********************** Helper functions **********************/
 const void check_pointer(const size_t *const size) {
@@ -38,8 +51,54 @@ const void check_xbar() {
     }
 }
 
+const nq::ADCTelemetry *check_adc_telemetry() {
+    check_xbar();
+    const nq::ADCTelemetry *telemetry = xbar->get_adc_telemetry();
+    if (telemetry == nullptr) {
+        std::cerr << "ADC telemetry is disabled. Set adc_telemetry in the "
+                     "config."
+                  << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return telemetry;
+}
+
+const nq::ADCSchedule *check_adc_schedule() {
+    check_xbar();
+    const nq::ADCSchedule *schedule = xbar->get_adc_schedule();
+    if (schedule == nullptr) {
+        std::cerr << "ADC sharing model is disabled. Set adc_share in the "
+                     "config."
+                  << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return schedule;
+}
+
+nq::Network *get_network(int32_t net) {
+    if ((net < 0) || (net >= static_cast<int32_t>(networks.size())) ||
+        (networks[net] == nullptr)) {
+        std::cerr << "Error: Invalid network handle " << net << "."
+                  << std::endl;
+        return nullptr;
+    }
+    return networks[net].get();
+}
+
+// Updates the crossbar after a config update: only recreate it if the
+// geometry or mapping was updated, otherwise keep the programmed weights
+void update_xbar(bool config_updated, nq::ConfigUpdate update) {
+    if (config_updated) {
+        if (update == nq::ConfigUpdate::REBUILD) {
+            xbar = std::make_unique<nq::Crossbar>(CFG);
+        } else {
+            xbar->reconfigure(update);
+        }
+    }
+}
+
 template <typename T>
-const uint32_t num_matrix_elems(const std::vector<std::vector<T>> &mat) {
+const uint32_t num_matrix_elems(const nq::Plane<T> &mat) {
     uint32_t size = 0;
     for (const auto &inner_vector : mat) {
         size += inner_vector.size();
@@ -51,7 +110,7 @@ const uint32_t num_matrix_elems(const std::vector<std::vector<T>> &mat) {
 extern "C" EXPORT_API void set_config(const char *cfg_file) {
     xbar = nullptr;
     nq::Config::get_cfg().load_cfg(cfg_file);
-    xbar = std::make_unique<nq::Crossbar>();
+    xbar = std::make_unique<nq::Crossbar>(CFG);
 }
 
 extern "C" EXPORT_API void update_config(const char *json_config) {
@@ -63,17 +122,27 @@ extern "C" EXPORT_API void update_config(const char *json_config) {
 
     check_xbar();
 
-    // Track whether parameters requiring crossbar recreation were updated
-    bool recreate_xbar = false;
+    // Track which crossbar state is invalidated by the updated parameters
+    nq::ConfigUpdate update = nq::ConfigUpdate::NONE;
 
     // Let Config class handle the JSON parsing and updates
     bool config_updated =
-        nq::Config::get_cfg().update_cfg(json_config, &recreate_xbar);
+        nq::Config::get_cfg().update_cfg(json_config, &update);
+    update_xbar(config_updated, update);
+}
 
-    // Only recreate crossbar if necessary keys were updated
-    if (config_updated && recreate_xbar) {
-        xbar = std::make_unique<nq::Crossbar>();
+extern "C" EXPORT_API int32_t save_config(const char *cfg_file) {
+    check_xbar();
+    if (cfg_file == nullptr) {
+        std::cerr << "Error: Config path is null." << std::endl;
+        return -1;
     }
+    return nq::Config::get_cfg().save_cfg(cfg_file) ? 0 : -1;
+}
+
+extern "C" EXPORT_API const uint64_t get_config_fingerprint() {
+    check_xbar();
+    return nq::Config::get_cfg().fingerprint();
 }
 
 extern "C" EXPORT_API int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
@@ -108,7 +177,14 @@ extern "C" EXPORT_API int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
                   << std::endl;
         return -1;
     }
-    xbar->mvm(res, vec, mat, m_matrix, n_matrix);
+    nq::TraceWriter &trace = nq::get_trace_recorder();
+    if (trace.is_open()) {
+        const std::vector<int32_t> res_in(res, res + m_matrix);
+        xbar->mvm(res, vec, mat, m_matrix, n_matrix);
+        trace.record_mvm(res_in.data(), res, vec, m_matrix, n_matrix, l_name);
+    } else {
+        xbar->mvm(res, vec, mat, m_matrix, n_matrix);
+    }
 #ifdef DEBUG_MODE
 // Find max and min values in the result vector
 #include <cstdint>
@@ -128,6 +204,41 @@ extern "C" EXPORT_API int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat,
     return 0;
 }
 
+// MVM with output-row gating: only the num_rows rows (ascending indices) are
+// activated and converted, res of the other rows is unchanged. Gated MVMs
+// are not recorded in the trace.
+extern "C" EXPORT_API int32_t exe_mvm_rows(int32_t *res, int32_t *vec,
+                                           int32_t *mat, int32_t m_matrix,
+                                           int32_t n_matrix,
+                                           const int32_t *rows,
+                                           int32_t num_rows) {
+    if (xbar == nullptr) {
+        std::cerr << "Error: Crossbar is not initialized. Please call "
+                     "set_config() first."
+                  << std::endl;
+        return -1;
+    }
+    if (m_matrix > CFG.M || n_matrix > CFG.N) {
+        std::cerr << "Error: Matrix dimensions exceed the crossbar size."
+                  << std::endl;
+        return -1;
+    }
+    if ((rows == nullptr) || (num_rows < 0)) {
+        std::cerr << "Error: Invalid row list." << std::endl;
+        return -1;
+    }
+    for (int32_t i = 0; i < num_rows; ++i) {
+        if ((rows[i] < 0) || (rows[i] >= m_matrix) ||
+            ((i > 0) && (rows[i] <= rows[i - 1]))) {
+            std::cerr << "Error: Rows must be ascending matrix rows."
+                      << std::endl;
+            return -1;
+        }
+    }
+    xbar->mvm(res, vec, mat, m_matrix, n_matrix, rows, num_rows);
+    return 0;
+}
+
 extern "C" EXPORT_API int32_t cpy_mtrx(int32_t *mat, int32_t m_matrix,
                                        int32_t n_matrix,
                                        const char *l_name = "Unkown") {
@@ -164,9 +275,158 @@ extern "C" EXPORT_API int32_t cpy_mtrx(int32_t *mat, int32_t m_matrix,
         return -1;
     }
     xbar->write(mat, m_matrix, n_matrix);
+    nq::TraceWriter &trace = nq::get_trace_recorder();
+    if (trace.is_open()) {
+        trace.record_cpy(mat, m_matrix, n_matrix, l_name);
+    }
+    return 0;
+}
+
+// Reprograms only the cells of the rows [row_off, row_off + m_matrix) and
+// columns [col_off, col_off + n_matrix), the other cells keep their weights.
+// Region writes are not recorded in the trace.
+extern "C" EXPORT_API int32_t write_region(int32_t *mat, int32_t row_off,
+                                           int32_t col_off, int32_t m_matrix,
+                                           int32_t n_matrix) {
+    if (xbar == nullptr) {
+        std::cerr << "Error: Crossbar is not initialized. Please call "
+                     "set_config() first."
+                  << std::endl;
+        return -1;
+    }
+    if ((row_off < 0) || (col_off < 0) || (m_matrix <= 0) ||
+        (n_matrix <= 0) || (row_off + m_matrix > CFG.M) ||
+        (col_off + n_matrix > CFG.N)) {
+        std::cerr << "Error: Region exceeds the crossbar size." << std::endl;
+        return -1;
+    }
+    xbar->write_region(mat, row_off, col_off, m_matrix, n_matrix);
+    return 0;
+}
+
+// Writes mat to a free region of the crossbar and returns its offsets for
+// exe_mvm_region, -1 if no region is free. cpy_mtrx removes all placements.
+extern "C" EXPORT_API int32_t place_mtrx(int32_t *mat, int32_t m_matrix,
+                                         int32_t n_matrix, int32_t *row_off,
+                                         int32_t *col_off) {
+    if (xbar == nullptr) {
+        std::cerr << "Error: Crossbar is not initialized. Please call "
+                     "set_config() first."
+                  << std::endl;
+        return -1;
+    }
+    if ((mat == nullptr) || (row_off == nullptr) || (col_off == nullptr) ||
+        (m_matrix <= 0) || (n_matrix <= 0)) {
+        std::cerr << "Error: Invalid matrix." << std::endl;
+        return -1;
+    }
+    if (!xbar->place(mat, m_matrix, n_matrix, row_off, col_off)) {
+        std::cerr << "Error: No free crossbar region for a " << m_matrix
+                  << "x" << n_matrix << " matrix." << std::endl;
+        return -1;
+    }
     return 0;
 }
 
+// MVM of the matrix in the rows [row_off, row_off + m_matrix) and columns
+// [col_off, col_off + n_matrix), e.g., of place_mtrx. Region MVMs are not
+// recorded in the trace.
+extern "C" EXPORT_API int32_t exe_mvm_region(int32_t *res, int32_t *vec,
+                                             int32_t row_off, int32_t col_off,
+                                             int32_t m_matrix,
+                                             int32_t n_matrix) {
+    if (xbar == nullptr) {
+        std::cerr << "Error: Crossbar is not initialized. Please call "
+                     "set_config() first."
+                  << std::endl;
+        return -1;
+    }
+    if ((row_off < 0) || (col_off < 0) || (m_matrix <= 0) ||
+        (n_matrix <= 0) || (row_off + m_matrix > CFG.M) ||
+        (col_off + n_matrix > CFG.N)) {
+        std::cerr << "Error: Region exceeds the crossbar size." << std::endl;
+        return -1;
+    }
+    xbar->mvm_region(res, vec, row_off, col_off, m_matrix, n_matrix);
+    return 0;
+}
+
+// Creates a crossbar for asynchronous MVMs with a copy of the current config
+// and programs mat, returns the handle
+extern "C" EXPORT_API int32_t xbar_create(const int32_t *mat, int32_t m_matrix,
+                                          int32_t n_matrix) {
+    check_xbar();
+    if (xbar_pool == nullptr) {
+        xbar_pool = std::make_unique<nq::CrossbarPool>(0);
+    }
+    return xbar_pool->add_xbar(mat, m_matrix, n_matrix);
+}
+
+// Creates a replica of a crossbar of xbar_create() that shares its programmed
+// weights (copy-on-write), returns the handle
+extern "C" EXPORT_API int32_t xbar_replicate(int32_t handle) {
+    if (xbar_pool == nullptr) {
+        std::cerr << "Error: No crossbar created with xbar_create()."
+                  << std::endl;
+        return -1;
+    }
+    return xbar_pool->replicate_xbar(handle);
+}
+
+// Number of crossbars (source and replicas) that share the programmed weights
+// of the crossbar, -1 on error
+extern "C" EXPORT_API int64_t xbar_weight_users(int32_t handle) {
+    if (xbar_pool == nullptr) {
+        std::cerr << "Error: No crossbar created with xbar_create()."
+                  << std::endl;
+        return -1;
+    }
+    return xbar_pool->get_weight_users(handle);
+}
+
+// Queues res += mat * vec on the crossbar and returns a ticket for
+// wait_mvm(), -1 on error. vec can be reused right away, res must stay valid
+// until the MVM is done. Asynchronous MVMs are not traced.
+extern "C" EXPORT_API int64_t submit_mvm(int32_t handle, int32_t *res,
+                                         const int32_t *vec, int32_t m_matrix,
+                                         int32_t n_matrix) {
+    if (xbar_pool == nullptr) {
+        std::cerr << "Error: No crossbar created with xbar_create()."
+                  << std::endl;
+        return -1;
+    }
+    return xbar_pool->submit_mvm(handle, res, vec, m_matrix, n_matrix);
+}
+
+extern "C" EXPORT_API int32_t wait_mvm(int64_t ticket) {
+    if ((xbar_pool == nullptr) || !xbar_pool->wait(ticket)) {
+        return -1;
+    }
+    return 0;
+}
+
+extern "C" EXPORT_API bool mvm_done(int64_t ticket) {
+    return (xbar_pool != nullptr) && xbar_pool->is_done(ticket);
+}
+
+// Waits for the queued MVMs of the crossbar and destroys it
+extern "C" EXPORT_API int32_t xbar_destroy(int32_t handle) {
+    if ((xbar_pool == nullptr) || !xbar_pool->remove_xbar(handle)) {
+        return -1;
+    }
+    return 0;
+}
+
+extern "C" EXPORT_API int32_t start_trace(const char *path) {
+    if (path == nullptr) {
+        std::cerr << "Error: Trace path is null." << std::endl;
+        return -1;
+    }
+    return nq::get_trace_recorder().open(path) ? 0 : -1;
+}
+
+extern "C" EXPORT_API void stop_trace() { nq::get_trace_recorder().close(); }
+
 extern "C" EXPORT_API const void *get_gd_p(size_t *size) {
     check_pointer(size);
     check_xbar();
@@ -249,6 +509,235 @@ extern "C" EXPORT_API const bool get_rd_run_out_of_bounds() {
     return xbar->get_rd_run_out_of_bounds();
 }
 
+extern "C" EXPORT_API int32_t save_xbar(const char *path) {
+    check_xbar();
+    if (path == nullptr) {
+        std::cerr << "Error: Snapshot path is null." << std::endl;
+        return -1;
+    }
+    return xbar->save(path) ? 0 : -1;
+}
+
+extern "C" EXPORT_API int32_t load_xbar(const char *path) {
+    check_xbar();
+    if (path == nullptr) {
+        std::cerr << "Error: Snapshot path is null." << std::endl;
+        return -1;
+    }
+    return xbar->load(path) ? 0 : -1;
+}
+
+extern "C" EXPORT_API int32_t run_sweep(const char *deltas,
+                                        const char *trace_path,
+                                        const char *csv_path,
+                                        uint32_t num_threads) {
+    check_xbar();
+    if ((deltas == nullptr) || (trace_path == nullptr) ||
+        (csv_path == nullptr)) {
+        std::cerr << "Error: Sweep argument is null." << std::endl;
+        return -1;
+    }
+    std::vector<nlohmann::json> points;
+    try {
+        points =
+            nlohmann::json::parse(deltas).get<std::vector<nlohmann::json>>();
+    } catch (const std::exception &e) {
+        std::cerr << "Error: Invalid sweep deltas: " << e.what() << std::endl;
+        return -1;
+    }
+    std::vector<nq::TraceRecord> workload;
+    if (!nq::read_trace(trace_path, workload)) {
+        return -1;
+    }
+
+    // Base config of the sweep is the current config
+    nq::SweepEngine engine(CFG, std::move(workload));
+    const std::vector<nq::SweepResult> results =
+        engine.run(points, num_threads);
+    sweep_num_programmed = engine.num_programmed();
+    return nq::SweepEngine::write_csv(csv_path, results) ? 0 : -1;
+}
+
+extern "C" EXPORT_API const uint64_t get_sweep_num_programmed() {
+    return sweep_num_programmed;
+}
+
+extern "C" EXPORT_API int32_t net_create() {
+    check_xbar();
+    // The network is based on the current config
+    networks.push_back(std::make_unique<nq::Network>(CFG));
+    return static_cast<int32_t>(networks.size()) - 1;
+}
+
+extern "C" EXPORT_API int32_t
+net_add_dense(int32_t net, const int32_t *weights, int32_t out_features,
+              int32_t in_features, const int32_t *bias, const float *scale,
+              int32_t num_scales, int32_t out_min, int32_t out_max,
+              const char *l_name = "Unknown") {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        return -1;
+    }
+    return network->add_dense(l_name, weights, out_features, in_features,
+                              bias, scale, num_scales, out_min, out_max)
+               ? 0
+               : -1;
+}
+
+// Square stride, padding and dilation (Conv2dParams supports them per axis)
+extern "C" EXPORT_API int32_t
+net_add_conv2d(int32_t net, const int32_t *weights, int32_t in_channels,
+               int32_t in_h, int32_t in_w, int32_t out_channels,
+               int32_t kernel_h, int32_t kernel_w, int32_t stride,
+               int32_t padding, int32_t dilation, int32_t groups,
+               const int32_t *bias, const float *scale, int32_t num_scales,
+               int32_t out_min, int32_t out_max,
+               const char *l_name = "Unknown") {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        return -1;
+    }
+    const nq::Conv2dParams params = {in_channels, in_h,     in_w,
+                                     out_channels, kernel_h, kernel_w,
+                                     stride,       stride,   padding,
+                                     padding,      dilation, dilation,
+                                     groups};
+    return network->add_conv2d(l_name, weights, params, bias, scale,
+                               num_scales, out_min, out_max)
+               ? 0
+               : -1;
+}
+
+// num_threads: threads for the tiles of a layer in net_run() (1: sequential,
+// 0: one per hardware thread)
+extern "C" EXPORT_API int32_t net_set_threads(int32_t net,
+                                              uint32_t num_threads) {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        return -1;
+    }
+    network->set_num_threads(num_threads);
+    return 0;
+}
+
+extern "C" EXPORT_API int32_t net_run(int32_t net, const int32_t *inputs,
+                                      int32_t batch, float *logits) {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        return -1;
+    }
+    return network->run(inputs, batch, logits) ? 0 : -1;
+}
+
+extern "C" EXPORT_API int32_t net_run_pipelined(int32_t net,
+                                                const int32_t *inputs,
+                                                int32_t batch, float *logits,
+                                                uint32_t queue_depth) {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        return -1;
+    }
+    return network->run_pipelined(inputs, batch, logits, queue_depth) ? 0
+                                                                       : -1;
+}
+
+extern "C" EXPORT_API int32_t net_num_layers(int32_t net) {
+    nq::Network *network = get_network(net);
+    return (network == nullptr) ? -1 : network->num_layers();
+}
+
+// occupancy: one value per layer (busy time of the stage / runtime) of the
+// last net_run_pipelined()
+extern "C" EXPORT_API int32_t net_stage_occupancy(int32_t net,
+                                                  double *occupancy) {
+    nq::Network *network = get_network(net);
+    if ((network == nullptr) || (occupancy == nullptr) ||
+        network->stage_stats().empty()) {
+        return -1;
+    }
+    for (const nq::StageStats &stats : network->stage_stats()) {
+        *occupancy++ = stats.occupancy;
+    }
+    return 0;
+}
+
+extern "C" EXPORT_API void net_destroy(int32_t net) {
+    if (get_network(net) != nullptr) {
+        networks[net] = nullptr;
+    }
+}
+
+extern "C" EXPORT_API const uint64_t *get_adc_hist(size_t *size) {
+    check_pointer(size);
+    const auto &hist = check_adc_telemetry()->get_hist();
+    if (hist.empty()) {
+        *size = 0;
+        return nullptr;
+    }
+    *size = hist.size();
+    return hist.data();
+}
+
+extern "C" EXPORT_API const int64_t get_adc_code_offset() {
+    return check_adc_telemetry()->get_code_offset();
+}
+
+extern "C" EXPORT_API const uint32_t get_adc_code_shift() {
+    return check_adc_telemetry()->get_code_shift();
+}
+
+extern "C" EXPORT_API const uint64_t get_adc_clip_low() {
+    return check_adc_telemetry()->get_clip_low();
+}
+
+extern "C" EXPORT_API const uint64_t get_adc_clip_high() {
+    return check_adc_telemetry()->get_clip_high();
+}
+
+extern "C" EXPORT_API const uint64_t get_adc_num_conversions() {
+    return check_adc_telemetry()->get_num_conversions();
+}
+
+extern "C" EXPORT_API const float get_adc_min_current() {
+    return check_adc_telemetry()->get_min_current();
+}
+
+extern "C" EXPORT_API const float get_adc_max_current() {
+    return check_adc_telemetry()->get_max_current();
+}
+
+extern "C" EXPORT_API void reset_adc_telemetry() {
+    check_adc_telemetry();
+    xbar->reset_adc_telemetry();
+}
+
+// Conversion cycles and latency (in ns) of the last MVM with shared ADCs
+extern "C" EXPORT_API const uint64_t get_adc_cycles() {
+    return check_adc_schedule()->get_cycles();
+}
+
+extern "C" EXPORT_API const float get_adc_latency() {
+    return check_adc_schedule()->get_latency();
+}
+
+// Sum over all MVMs since the last reset, e.g., for the throughput
+extern "C" EXPORT_API const uint64_t get_adc_total_cycles() {
+    return check_adc_schedule()->get_total_cycles();
+}
+
+extern "C" EXPORT_API const uint64_t get_adc_scheduled_mvms() {
+    return check_adc_schedule()->get_num_mvms();
+}
+
+extern "C" EXPORT_API const uint32_t get_adc_num_adcs() {
+    return check_adc_schedule()->get_num_adcs();
+}
+
+extern "C" EXPORT_API void reset_adc_schedule() {
+    check_adc_schedule();
+    xbar->reset_adc_schedule();
+}
+
 /********************* Pybind interface *********************/
 int32_t exe_mvm_pb(pybind11::array_t<int32_t> res,
                    pybind11::array_t<int32_t> vec,
@@ -262,8 +751,115 @@ int32_t exe_mvm_pb(pybind11::array_t<int32_t> res,
     int32_t *vec_ptr = static_cast<int32_t *>(vec_buffer.ptr);
     int32_t *mat_ptr = static_cast<int32_t *>(mat_buffer.ptr);
 
-    xbar->mvm(res_ptr, vec_ptr, mat_ptr, m_matrix, n_matrix);
-    return 0;
+    return exe_mvm(res_ptr, vec_ptr, mat_ptr, m_matrix, n_matrix);
+}
+
+int32_t exe_mvm_rows_pb(pybind11::array_t<int32_t> res,
+                        pybind11::array_t<int32_t> vec,
+                        pybind11::array_t<int32_t> mat, int32_t m_matrix,
+                        int32_t n_matrix, pybind11::array_t<int32_t> rows) {
+    auto res_buffer = res.request();
+    auto vec_buffer = vec.request();
+    auto mat_buffer = mat.request();
+    auto rows_buffer = rows.request();
+    if ((res_buffer.size < m_matrix) || (vec_buffer.size < n_matrix)) {
+        throw pybind11::value_error("res or vec is too small.");
+    }
+
+    int32_t *res_ptr = static_cast<int32_t *>(res_buffer.ptr);
+    int32_t *vec_ptr = static_cast<int32_t *>(vec_buffer.ptr);
+    int32_t *mat_ptr = static_cast<int32_t *>(mat_buffer.ptr);
+    const int32_t *rows_ptr = static_cast<const int32_t *>(rows_buffer.ptr);
+
+    return exe_mvm_rows(res_ptr, vec_ptr, mat_ptr, m_matrix, n_matrix,
+                        rows_ptr, rows_buffer.size);
+}
+
+// Result of mvm_async(). The MVM accumulates into a copy of res owned by the
+// future (res can be a temporary of a cast), result() copies it back to res.
+// A future dropped before its MVM is done waits for it.
+struct MvmFuture {
+    MvmFuture(pybind11::array_t<int32_t> res, const int32_t *res_ptr,
+              int32_t m_matrix) :
+        ticket(-1), res(std::move(res)), out(res_ptr, res_ptr + m_matrix) {}
+    MvmFuture(const MvmFuture &) = delete;
+    MvmFuture(MvmFuture &&other) noexcept :
+        ticket(other.ticket), res(std::move(other.res)),
+        out(std::move(other.out)) {
+        other.ticket = -1;
+    }
+    ~MvmFuture() {
+        if (ticket >= 0) {
+            pybind11::gil_scoped_release release;
+            wait_mvm(ticket);
+        }
+    }
+
+    bool done() const { return mvm_done(ticket); }
+
+    pybind11::array_t<int32_t> result() {
+        int32_t status;
+        {
+            pybind11::gil_scoped_release release;
+            status = wait_mvm(ticket);
+        }
+        if (status != 0) {
+            throw pybind11::runtime_error("Asynchronous MVM failed.");
+        }
+        auto res_buffer = res.request();
+        std::copy(out.begin(), out.end(),
+                  static_cast<int32_t *>(res_buffer.ptr));
+        return res;
+    }
+
+    int64_t ticket;
+    pybind11::array_t<int32_t> res;
+    std::vector<int32_t> out; // Written by the pool worker
+};
+
+int32_t xbar_create_pb(pybind11::array_t<int32_t> mat) {
+    auto mat_buffer = mat.request();
+    if (mat_buffer.ndim != 2) {
+        throw pybind11::value_error("Matrix must be a 2D array.");
+    }
+    const int32_t handle =
+        xbar_create(static_cast<const int32_t *>(mat_buffer.ptr),
+                    mat_buffer.shape[0], mat_buffer.shape[1]);
+    if (handle < 0) {
+        throw pybind11::value_error("Crossbar creation failed.");
+    }
+    return handle;
+}
+
+int32_t xbar_replicate_pb(int32_t handle) {
+    const int32_t replica = xbar_replicate(handle);
+    if (replica < 0) {
+        throw pybind11::value_error("Crossbar replication failed.");
+    }
+    return replica;
+}
+
+MvmFuture mvm_async_pb(int32_t handle, pybind11::array_t<int32_t> res,
+                       pybind11::array_t<int32_t> vec, int32_t m_matrix,
+                       int32_t n_matrix) {
+    auto res_buffer = res.request();
+    auto vec_buffer = vec.request();
+    if ((m_matrix <= 0) || (n_matrix <= 0)) {
+        throw pybind11::value_error("Invalid matrix dimensions.");
+    }
+    if ((res_buffer.size < m_matrix) || (vec_buffer.size < n_matrix)) {
+        throw pybind11::value_error("res or vec is too small.");
+    }
+
+    MvmFuture future(res, static_cast<const int32_t *>(res_buffer.ptr),
+                     m_matrix);
+    future.ticket = submit_mvm(handle, future.out.data(),
+                               static_cast<const int32_t *>(vec_buffer.ptr),
+                               m_matrix, n_matrix);
+    if (future.ticket < 0) {
+        throw pybind11::value_error("MVM submission failed.");
+    }
+    return future;
 }
 
 int32_t cpy_mtrx_pb(pybind11::array_t<int32_t> mat, int32_t m_matrix,
@@ -273,6 +869,45 @@ int32_t cpy_mtrx_pb(pybind11::array_t<int32_t> mat, int32_t m_matrix,
     return cpy_mtrx(mat_ptr, m_matrix, n_matrix);
 }
 
+int32_t write_region_pb(pybind11::array_t<int32_t> mat, int32_t row_off,
+                        int32_t col_off, int32_t m_matrix, int32_t n_matrix) {
+    auto mat_buffer = mat.request();
+    if (mat_buffer.size != static_cast<ssize_t>(m_matrix) * n_matrix) {
+        throw std::invalid_argument("Matrix size does not match m x n.");
+    }
+    int32_t *mat_ptr = static_cast<int32_t *>(mat_buffer.ptr);
+    return write_region(mat_ptr, row_off, col_off, m_matrix, n_matrix);
+}
+
+pybind11::tuple place_mtrx_pb(pybind11::array_t<int32_t> mat, int32_t m_matrix,
+                              int32_t n_matrix) {
+    auto mat_buffer = mat.request();
+    if (mat_buffer.size != static_cast<ssize_t>(m_matrix) * n_matrix) {
+        throw std::invalid_argument("Matrix size does not match m x n.");
+    }
+    int32_t *mat_ptr = static_cast<int32_t *>(mat_buffer.ptr);
+    int32_t row_off = 0;
+    int32_t col_off = 0;
+    if (place_mtrx(mat_ptr, m_matrix, n_matrix, &row_off, &col_off) != 0) {
+        throw pybind11::value_error("Matrix placement failed.");
+    }
+    return pybind11::make_tuple(row_off, col_off);
+}
+
+int32_t exe_mvm_region_pb(pybind11::array_t<int32_t> res,
+                          pybind11::array_t<int32_t> vec, int32_t row_off,
+                          int32_t col_off, int32_t m_matrix, int32_t n_matrix) {
+    auto res_buffer = res.request();
+    auto vec_buffer = vec.request();
+    if ((res_buffer.size < m_matrix) || (vec_buffer.size < n_matrix)) {
+        throw pybind11::value_error("res or vec is too small.");
+    }
+    int32_t *res_ptr = static_cast<int32_t *>(res_buffer.ptr);
+    int32_t *vec_ptr = static_cast<int32_t *>(vec_buffer.ptr);
+    return exe_mvm_region(res_ptr, vec_ptr, row_off, col_off, m_matrix,
+                          n_matrix);
+}
+
 pybind11::array_t<uint32_t> get_gd_p_pb() {
     check_xbar();
 
@@ -409,6 +1044,147 @@ pybind11::array_t<uint64_t> get_consecutive_reads_m_pb() {
     return result;
 }
 
+int32_t save_xbar_pb(const std::string &path) {
+    return save_xbar(path.c_str());
+}
+
+int32_t load_xbar_pb(const std::string &path) {
+    return load_xbar(path.c_str());
+}
+
+int32_t start_trace_pb(const std::string &path) {
+    return start_trace(path.c_str());
+}
+
+int32_t run_sweep_pb(const std::string &deltas, const std::string &trace_path,
+                     const std::string &csv_path, uint32_t num_threads) {
+    return run_sweep(deltas.c_str(), trace_path.c_str(), csv_path.c_str(),
+                     num_threads);
+}
+
+int32_t net_add_dense_pb(int32_t net, pybind11::array_t<int32_t> weights,
+                         pybind11::array_t<int32_t> bias,
+                         pybind11::array_t<float> scale, int32_t out_min,
+                         int32_t out_max, const std::string &l_name) {
+    auto weights_buffer = weights.request();
+    auto bias_buffer = bias.request();
+    auto scale_buffer = scale.request();
+    if (weights_buffer.ndim != 2) {
+        throw pybind11::value_error("Weights must be a 2D array.");
+    }
+    const int32_t out_features = weights_buffer.shape[0];
+    if ((bias_buffer.size != 0) && (bias_buffer.size != out_features)) {
+        throw pybind11::value_error("One bias per output expected.");
+    }
+
+    return net_add_dense(
+        net, static_cast<const int32_t *>(weights_buffer.ptr), out_features,
+        weights_buffer.shape[1],
+        (bias_buffer.size == 0) ? nullptr
+                                : static_cast<const int32_t *>(bias_buffer.ptr),
+        static_cast<const float *>(scale_buffer.ptr), scale_buffer.size,
+        out_min, out_max, l_name.c_str());
+}
+
+int32_t net_add_conv2d_pb(int32_t net, pybind11::array_t<int32_t> weights,
+                          pybind11::array_t<int32_t> bias,
+                          pybind11::array_t<float> scale, int32_t in_h,
+                          int32_t in_w, int32_t stride, int32_t padding,
+                          int32_t dilation, int32_t groups, int32_t out_min,
+                          int32_t out_max, const std::string &l_name) {
+    auto weights_buffer = weights.request();
+    auto bias_buffer = bias.request();
+    auto scale_buffer = scale.request();
+    if (weights_buffer.ndim != 4) {
+        throw pybind11::value_error(
+            "Weights must be a 4D array (out_channels x in_channels / groups "
+            "x kernel_h x kernel_w).");
+    }
+    const int32_t out_channels = weights_buffer.shape[0];
+    if ((bias_buffer.size != 0) && (bias_buffer.size != out_channels)) {
+        throw pybind11::value_error("One bias per output channel expected.");
+    }
+
+    return net_add_conv2d(
+        net, static_cast<const int32_t *>(weights_buffer.ptr),
+        weights_buffer.shape[1] * groups, in_h, in_w, out_channels,
+        weights_buffer.shape[2], weights_buffer.shape[3], stride, padding,
+        dilation, groups,
+        (bias_buffer.size == 0) ? nullptr
+                                : static_cast<const int32_t *>(bias_buffer.ptr),
+        static_cast<const float *>(scale_buffer.ptr), scale_buffer.size,
+        out_min, out_max, l_name.c_str());
+}
+
+// queue_depth = 0: sequential execution, otherwise pipelined
+pybind11::array_t<float> run_network_pb(int32_t net,
+                                        pybind11::array_t<int32_t> inputs,
+                                        int32_t queue_depth) {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        throw pybind11::value_error("Invalid network handle.");
+    }
+    auto inputs_buffer = inputs.request();
+    if ((inputs_buffer.ndim != 2) ||
+        (inputs_buffer.shape[1] != network->in_size())) {
+        throw pybind11::value_error("Inputs must be a 2D array (batch x "
+                                    "input size of the first layer).");
+    }
+
+    const size_t batch = inputs_buffer.shape[0];
+    pybind11::array_t<float> logits(
+        {batch, static_cast<size_t>(network->out_size())});
+    const int32_t *inputs_ptr = static_cast<int32_t *>(inputs_buffer.ptr);
+    float *logits_ptr = logits.mutable_data();
+    int32_t status;
+    {
+        // The whole network runs without the GIL
+        pybind11::gil_scoped_release release;
+        if (queue_depth > 0) {
+            status = net_run_pipelined(net, inputs_ptr, batch, logits_ptr,
+                                       queue_depth);
+        } else {
+            status = net_run(net, inputs_ptr, batch, logits_ptr);
+        }
+    }
+    if (status != 0) {
+        throw pybind11::runtime_error("Network execution failed.");
+    }
+    return logits;
+}
+
+pybind11::array_t<float> net_run_pb(int32_t net,
+                                    pybind11::array_t<int32_t> inputs) {
+    return run_network_pb(net, inputs, 0);
+}
+
+pybind11::array_t<float> net_run_pipelined_pb(int32_t net,
+                                              pybind11::array_t<int32_t> inputs,
+                                              int32_t queue_depth) {
+    return run_network_pb(net, inputs, std::max(queue_depth, 1));
+}
+
+pybind11::array_t<double> net_stage_occupancy_pb(int32_t net) {
+    nq::Network *network = get_network(net);
+    if (network == nullptr) {
+        throw pybind11::value_error("Invalid network handle.");
+    }
+    pybind11::array_t<double> result(network->stage_stats().size());
+    net_stage_occupancy(net, result.mutable_data());
+    return result;
+}
+
+pybind11::array_t<uint64_t> get_adc_hist_pb() {
+    const auto &hist = check_adc_telemetry()->get_hist();
+
+    pybind11::array_t<uint64_t> result(hist.size());
+    uint64_t *r = result.mutable_data();
+    for (size_t i = 0; i < hist.size(); ++i) {
+        r[i] = hist[i];
+    }
+    return result;
+}
+
 void update_config_pb(const std::string &json_config) {
     // Check if JSON string is empty
     if (json_config.empty()) {
@@ -421,46 +1197,133 @@ void update_config_pb(const std::string &json_config) {
     update_config(json_config.c_str());
 }
 
+// Converts a Python config value (dict, list, str, bool, int, float, None)
+// to JSON
+nlohmann::json to_json(const pybind11::handle &value) {
+    if (value.is_none()) {
+        return nullptr;
+    }
+    // bool before int: bool is a subclass of int in Python
+    if (pybind11::isinstance<pybind11::bool_>(value)) {
+        return value.cast<bool>();
+    }
+    if (pybind11::isinstance<pybind11::int_>(value)) {
+        return value.cast<int64_t>();
+    }
+    if (pybind11::isinstance<pybind11::float_>(value)) {
+        return value.cast<double>();
+    }
+    if (pybind11::isinstance<pybind11::str>(value)) {
+        return value.cast<std::string>();
+    }
+    if (pybind11::isinstance<pybind11::dict>(value)) {
+        nlohmann::json obj = nlohmann::json::object();
+        for (const auto &item : value.cast<pybind11::dict>()) {
+            obj[item.first.cast<std::string>()] = to_json(item.second);
+        }
+        return obj;
+    }
+    if (pybind11::isinstance<pybind11::list>(value) ||
+        pybind11::isinstance<pybind11::tuple>(value)) {
+        nlohmann::json arr = nlohmann::json::array();
+        for (const auto &elem : value) {
+            arr.push_back(to_json(elem));
+        }
+        return arr;
+    }
+    throw pybind11::type_error("Unsupported config value type.");
+}
+
+// Applies the config updates without serializing them to a JSON string
+void update_config_dict_pb(const pybind11::dict &updates) {
+    check_xbar();
+    nq::ConfigUpdate update = nq::ConfigUpdate::NONE;
+    bool config_updated =
+        nq::Config::get_cfg().update_cfg(to_json(updates), &update);
+    update_xbar(config_updated, update);
+}
+
+int32_t save_config_pb(const std::string &cfg_file) {
+    return save_config(cfg_file.c_str());
+}
+
 /*********************** C++ interface ***********************/
-EXPORT_API const std::vector<std::vector<int32_t>> &get_gd_p() {
+EXPORT_API const nq::Plane<int32_t> &get_gd_p() {
     return xbar->get_gd_p();
 }
 
-EXPORT_API const std::vector<std::vector<int32_t>> &get_gd_m() {
+EXPORT_API const nq::Plane<int32_t> &get_gd_m() {
     return xbar->get_gd_m();
 }
 
-EXPORT_API const std::vector<std::vector<float>> &get_ia_p() {
+EXPORT_API const nq::Plane<float> &get_ia_p() {
     return xbar->get_ia_p();
 }
 
-EXPORT_API const std::vector<std::vector<float>> &get_ia_m() {
+EXPORT_API const nq::Plane<float> &get_ia_m() {
     return xbar->get_ia_m();
 }
 
-EXPORT_API const std::vector<std::vector<uint64_t>> &get_cycles_p() {
+EXPORT_API const nq::Plane<uint64_t> &get_cycles_p() {
     return xbar->get_cycles_p();
 }
 
-EXPORT_API const std::vector<std::vector<uint64_t>> &get_cycles_m() {
+EXPORT_API const nq::Plane<uint64_t> &get_cycles_m() {
     return xbar->get_cycles_m();
 }
 
-EXPORT_API const std::vector<std::vector<uint64_t>> &get_consecutive_reads_p() {
+EXPORT_API const nq::Plane<uint64_t> &get_consecutive_reads_p() {
     return xbar->get_consecutive_reads_p();
 }
 
-EXPORT_API const std::vector<std::vector<uint64_t>> &get_consecutive_reads_m() {
+EXPORT_API const nq::Plane<uint64_t> &get_consecutive_reads_m() {
     return xbar->get_consecutive_reads_m();
 }
 
 /********************* Pybind definitions *********************/
 PYBIND11_MODULE(acs_int, m) {
     m.def("cpy", &cpy_mtrx_pb, "Copy matrix to crossbar.");
+    m.def("write_region", &write_region_pb,
+          "Copy a matrix to a region (row and column offset) of the "
+          "crossbar, only the cells of the region are reprogrammed.");
+    m.def("place", &place_mtrx_pb,
+          "Copy a matrix to a free region of the crossbar, returns the "
+          "(row, column) offset.");
     m.def("mvm", &exe_mvm_pb, "Execute matrix-vector multiplication.");
+    m.def("mvm_rows", &exe_mvm_rows_pb,
+          "Execute matrix-vector multiplication for the selected (ascending) "
+          "output rows only.");
+    m.def("mvm_region", &exe_mvm_region_pb,
+          "Execute the matrix-vector multiplication of a crossbar region, "
+          "only its rows and columns are activated.");
+    pybind11::class_<MvmFuture>(m, "MvmFuture")
+        .def("done", &MvmFuture::done, "Check if the MVM is done.")
+        .def("result", &MvmFuture::result,
+             "Wait for the MVM and return the result array.");
+    m.def("xbar_create", &xbar_create_pb,
+          "Create a crossbar for asynchronous MVMs with the current config and "
+          "program the matrix, returns a handle.");
+    m.def("xbar_replicate", &xbar_replicate_pb,
+          "Create a replica of a crossbar that shares the programmed weights, "
+          "returns a handle.");
+    m.def("xbar_weight_users", &xbar_weight_users,
+          "Number of crossbars that share the programmed weights of a "
+          "crossbar.");
+    m.def("mvm_async", &mvm_async_pb,
+          "Queue res += mat * vec on a crossbar of xbar_create, returns a "
+          "future (done(), result()).");
+    m.def("xbar_destroy", &xbar_destroy,
+          "Wait for the queued MVMs of a crossbar and destroy it.");
     m.def("set_config", &set_config, "Set a config for the crossbar.");
     m.def("update_config", &update_config_pb,
           "Update configuration from JSON string.");
+    m.def("update_config", &update_config_dict_pb,
+          "Update configuration from a dict (no JSON serialization).");
+    m.def("save_config", &save_config_pb,
+          "Save the config in a compact binary format (loadable with "
+          "set_config).");
+    m.def("config_fingerprint", &get_config_fingerprint,
+          "Get the hash of the config (e.g., as key of cached crossbars).");
     m.def("gd_p", &get_gd_p_pb,
           "Get the positive (digital) conductance matrix.");
     m.def("gd_m", &get_gd_m_pb,
@@ -491,4 +1354,74 @@ PYBIND11_MODULE(acs_int, m) {
           "Get the number of refresh operations on the cells.");
     m.def("rd_run_out_of_bounds", &get_rd_run_out_of_bounds,
           "Check if the read disturb model ran out of bounds.");
+    m.def("save", &save_xbar_pb,
+          "Save the crossbar state (cells, read disturb state, counters) to a "
+          "snapshot file.");
+    m.def("load", &load_xbar_pb,
+          "Load the crossbar state from a snapshot file (same config).");
+    m.def("start_trace", &start_trace_pb,
+          "Record all cpy/mvm calls to a trace file (see acs_replay).");
+    m.def("stop_trace", &stop_trace, "Stop recording the trace.");
+    m.def("sweep", &run_sweep_pb,
+          "Evaluate config deltas (JSON array) on a trace in parallel, based "
+          "on the current config, and write the results to a CSV file "
+          "(num_threads = 0: all hardware threads).");
+    m.def("sweep_num_programmed", &get_sweep_num_programmed,
+          "Number of crossbars programmed by the last sweep (one per "
+          "crossbar geometry).");
+    m.def("net_create", &net_create,
+          "Create a network based on the current config, returns a handle.");
+    m.def("net_add_dense", &net_add_dense_pb,
+          "Append a dense layer (weights: out x in, bias: empty or one per "
+          "output, scale: one or one per output, outputs are requantized to "
+          "[out_min, out_max]).");
+    m.def("net_add_conv2d", &net_add_conv2d_pb,
+          "Append a 2D convolution (weights: out_channels x in_channels / "
+          "groups x kernel_h x kernel_w, inputs and outputs in CHW layout) "
+          "with stride, padding, dilation and groups, lowered to crossbar "
+          "MVMs with an implicit im2col.");
+    m.def("net_run", &net_run_pb,
+          "Run a batch (batch x in) through the network, returns the logits.");
+    m.def("net_set_threads", &net_set_threads,
+          "Set the number of threads for the tiles of a layer in net_run "
+          "(work stealing, 1: sequential, 0: all hardware threads).");
+    m.def("net_run_pipelined", &net_run_pipelined_pb,
+          "Run a batch through the network with one pipeline stage (thread) "
+          "per layer, queue_depth inputs are buffered between two stages.");
+    m.def("net_stage_occupancy", &net_stage_occupancy_pb,
+          "Get the occupancy (busy time / runtime) of each pipeline stage of "
+          "the last pipelined run.");
+    m.def("net_destroy", &net_destroy, "Destroy a network.");
+    m.def("adc_hist", &get_adc_hist_pb,
+          "Get the histogram of the ADC codes (requires adc_telemetry).");
+    m.def("adc_code_offset", &get_adc_code_offset,
+          "Get the ADC code of the first histogram bin.");
+    m.def("adc_code_shift", &get_adc_code_shift,
+          "Get log2 of the number of ADC codes per histogram bin.");
+    m.def("adc_clip_low", &get_adc_clip_low,
+          "Get the number of currents clipped at the lower ADC rail.");
+    m.def("adc_clip_high", &get_adc_clip_high,
+          "Get the number of currents clipped at the upper ADC rail.");
+    m.def("adc_conversions", &get_adc_num_conversions,
+          "Get the number of recorded ADC conversions.");
+    m.def("adc_min_current", &get_adc_min_current,
+          "Get the smallest pre-ADC current (in uA).");
+    m.def("adc_max_current", &get_adc_max_current,
+          "Get the largest pre-ADC current (in uA).");
+    m.def("reset_adc_telemetry", &reset_adc_telemetry,
+          "Reset the ADC telemetry.");
+    m.def("adc_cycles", &get_adc_cycles,
+          "Get the conversion cycles of the last MVM (requires adc_share).");
+    m.def("adc_latency", &get_adc_latency,
+          "Get the conversion latency of the last MVM in ns (requires "
+          "adc_share).");
+    m.def("adc_total_cycles", &get_adc_total_cycles,
+          "Get the conversion cycles of all MVMs since the last reset "
+          "(requires adc_share).");
+    m.def("adc_scheduled_mvms", &get_adc_scheduled_mvms,
+          "Get the number of MVMs since the last reset (requires adc_share).");
+    m.def("adc_num_adcs", &get_adc_num_adcs,
+          "Get the number of shared ADCs (requires adc_share).");
+    m.def("reset_adc_schedule", &reset_adc_schedule,
+          "Reset the cycle counters of the shared ADCs.");
 }
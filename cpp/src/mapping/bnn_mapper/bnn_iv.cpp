@@ -10,27 +10,34 @@
 
 namespace nq {
 
-MapperBnnIV::MapperBnnIV() :
-    vd_p_(CFG.N, 0), vd_m_(CFG.N, 0), tmp_out_(CFG.M, 0.0),
-    tmp_out_p_(CFG.M, 0.0), tmp_out_m_(CFG.M, 0.0), Mapper(false) {}
+MapperBnnIV::MapperBnnIV(const Config &cfg,
+                         std::shared_ptr<ProgrammedWeights> weights) :
+    vd_p_(cfg.N, 0), vd_m_(cfg.N, 0), tmp_out_(cfg.M, 0.0),
+    tmp_out_p_(cfg.M, 0.0), tmp_out_m_(cfg.M, 0.0),
+    Mapper(cfg, false, std::move(weights)) {}
 
 MapperBnnIV::~MapperBnnIV() {}
 
-void MapperBnnIV::d_write(const int32_t *mat, int32_t m_matrix,
-                          int32_t n_matrix) {
+void MapperBnnIV::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix) {
+    Plane<int32_t> &gd_p = mutable_weights().gd_p;
     for (size_t m = 0; m < m_matrix; ++m) {
         for (size_t n = 0; n < n_matrix; ++n) {
-            gd_p_[m][n] = (mat[n_matrix * m + n] - 1) / -2;
+            gd_p[row_off + m][col_off + n] =
+                (mat[n_matrix * m + n] - 1) / -2;
         }
     }
 }
 
-void MapperBnnIV::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p_bnn(m_matrix, n_matrix);
+void MapperBnnIV::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                          int32_t n_end) {
+    a_write_p_bnn(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperBnnIV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                        int32_t m_matrix, int32_t n_matrix) {
+                        int32_t row_off, int32_t col_off, int32_t m_matrix,
+                        int32_t n_matrix) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
     int32_t vec_sum = 0;
 
     for (size_t n = 0; n < n_matrix; ++n) {
@@ -48,15 +55,17 @@ void MapperBnnIV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
+        const int32_t *g_p = gd_p[row_off + m].data() + col_off;
         res[m] += vec_sum;
         for (size_t n = 0; n < n_matrix; ++n) {
-            res[m] += 2 * (gd_p_[m][n] * vd_m_[n] - gd_p_[m][n] * vd_p_[n]);
+            res[m] += 2 * (g_p[n] * vd_m_[n] - g_p[n] * vd_p_[n]);
         }
     }
 }
 
 void MapperBnnIV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                        int32_t m_matrix, int32_t n_matrix) {
+                        int32_t row_off, int32_t col_off, int32_t m_matrix,
+                        int32_t n_matrix) {
     std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
     std::fill(tmp_out_p_.begin(), tmp_out_p_.end(), 0.0);
     std::fill(tmp_out_m_.begin(), tmp_out_m_.end(), 0.0);
@@ -77,20 +86,21 @@ void MapperBnnIV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
+        const float *i_p = ia_p_[row_off + m].data() + col_off;
         for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_p_[m] += (ia_p_[m][n] * vd_p_[n]);
-            tmp_out_m_[m] += (ia_p_[m][n] * vd_m_[n]);
+            tmp_out_p_[m] += (i_p[n] * vd_p_[n]);
+            tmp_out_m_[m] += (i_p[n] * vd_m_[n]);
         }
     }
 
+    adc_->convert(tmp_out_p_.data(), tmp_out_p_.data(), m_matrix);
+    adc_->convert(tmp_out_m_.data(), tmp_out_m_.data(), m_matrix);
     for (size_t m = 0; m < m_matrix; ++m) {
-        tmp_out_[m] += 2 / i_mm_ *
-                       (adc_->analog_digital_conversion(tmp_out_m_[m]) -
-                        adc_->analog_digital_conversion(tmp_out_p_[m]));
+        tmp_out_[m] += 2 / i_mm_ * (tmp_out_m_[m] - tmp_out_p_[m]);
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
-        res[m] += round(tmp_out_[m] + vec_sum + vec_sum * 2 * CFG.HRS / i_mm_);
+        res[m] += round(tmp_out_[m] + vec_sum + vec_sum * 2 * cfg_.HRS / i_mm_);
     }
 }
 
@@ -10,22 +10,28 @@
 
 namespace nq {
 
-MapperBnnVI::MapperBnnVI() :
-    vd_p_(CFG.N, 0), vd_m_(CFG.N, 0), tmp_out_(CFG.M, 0.0), Mapper(true) {}
+MapperBnnVI::MapperBnnVI(const Config &cfg,
+                         std::shared_ptr<ProgrammedWeights> weights) :
+    vd_p_(cfg.N, 0), vd_m_(cfg.N, 0), tmp_out_(cfg.M, 0.0),
+    Mapper(cfg, true, std::move(weights)) {}
 
 MapperBnnVI::~MapperBnnVI() {}
 
-void MapperBnnVI::d_write(const int32_t *mat, int32_t m_matrix,
-                          int32_t n_matrix) {
-    d_write_diff_bnn(mat, m_matrix, n_matrix);
+void MapperBnnVI::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix) {
+    d_write_diff_bnn(mat, row_off, col_off, m_matrix, n_matrix);
 }
 
-void MapperBnnVI::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p_m_bnn_tnn(m_matrix, n_matrix);
+void MapperBnnVI::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                          int32_t n_end) {
+    a_write_p_m_bnn_tnn(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperBnnVI::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                        int32_t m_matrix, int32_t n_matrix) {
+                        int32_t row_off, int32_t col_off, int32_t m_matrix,
+                        int32_t n_matrix) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
     for (size_t n = 0; n < n_matrix; ++n) {
         if (vec[n] == +1) {
             vd_p_[n] = 1;
@@ -40,15 +46,18 @@ void MapperBnnVI::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
+        const int32_t *g_p = gd_p[row_off + m].data() + col_off;
+        const int32_t *g_m = gd_m[row_off + m].data() + col_off;
         for (size_t n = 0; n < n_matrix; ++n) {
-            res[m] += gd_p_[m][n] * vd_p_[n] + gd_m_[m][n] * vd_m_[n] -
-                      gd_m_[m][n] * vd_p_[n] - gd_p_[m][n] * vd_m_[n];
+            res[m] += g_p[n] * vd_p_[n] + g_m[n] * vd_m_[n] -
+                      g_m[n] * vd_p_[n] - g_p[n] * vd_m_[n];
         }
     }
 }
 
 void MapperBnnVI::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                        int32_t m_matrix, int32_t n_matrix) {
+                        int32_t row_off, int32_t col_off, int32_t m_matrix,
+                        int32_t n_matrix) {
     std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
 
     for (size_t n = 0; n < n_matrix; ++n) {
@@ -65,14 +74,17 @@ void MapperBnnVI::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
+        const float *i_p = ia_p_[row_off + m].data() + col_off;
+        const float *i_m = ia_m_[row_off + m].data() + col_off;
         for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_[m] += ia_p_[m][n] * vd_p_[n] + ia_m_[m][n] * vd_m_[n] -
-                           ia_m_[m][n] * vd_p_[n] - ia_p_[m][n] * vd_m_[n];
+            tmp_out_[m] += i_p[n] * vd_p_[n] + i_m[n] * vd_m_[n] -
+                           i_m[n] * vd_p_[n] - i_p[n] * vd_m_[n];
         }
     }
 
+    adc_->convert(tmp_out_.data(), tmp_out_.data(), m_matrix);
     for (size_t m = 0; m < m_matrix; ++m) {
-        res[m] += round(adc_->analog_digital_conversion(tmp_out_[m]) / i_mm_);
+        res[m] += round(tmp_out_[m] / i_mm_);
     }
 }
 
@@ -7,32 +7,70 @@
  ******************************************************************************/
 #include "mapping/int_mapper/int_i.h"
 #include "helper/config.h"
+#include "mapping/int_mapper/int_kernel.h"
 
 namespace nq {
 
-MapperIntI::MapperIntI() :
-    vd_p_(CFG.N, 0), vd_m_(CFG.N, 0), tmp_out_int_(CFG.M * CFG.SPLIT.size(), 0),
-    tmp_out_fp_(CFG.M * CFG.SPLIT.size(), 0.0), Mapper(true) {}
+MapperIntI::MapperIntI(const Config &cfg,
+                       std::shared_ptr<ProgrammedWeights> weights) :
+    vd_p_(cfg.N, 0), vd_m_(cfg.N, 0), tmp_out_int_(cfg.M * cfg.SPLIT.size(), 0),
+    tmp_out_fp_(cfg.M * cfg.SPLIT.size(), 0.0),
+    Mapper(cfg, true, std::move(weights)) {
+    dispatch_kernel([this](auto num_seg, auto i_bit) {
+        d_mvm_ = &MapperIntI::d_mvm_kernel<num_seg(), i_bit()>;
+        a_mvm_ = &MapperIntI::a_mvm_kernel<num_seg(), i_bit()>;
+    });
+}
 
 MapperIntI::~MapperIntI() {}
 
-void MapperIntI::d_write(const int32_t *mat, int32_t m_matrix,
-                         int32_t n_matrix) {
-    d_write_diff(mat, m_matrix, n_matrix);
+void MapperIntI::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                         int32_t m_matrix, int32_t n_matrix) {
+    d_write_diff(mat, row_off, col_off, m_matrix, n_matrix);
 }
 
-void MapperIntI::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p_m(m_matrix, n_matrix);
+void MapperIntI::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                         int32_t n_end) {
+    a_write_p_m(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperIntI::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    (this->*d_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+void MapperIntI::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    (this->*a_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntI::d_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
+                              int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
-    // per original matrix value) Two matrices exist: gd+ (gd_p_) and gd-
-    // (gd_m_) The input is also split into positive and negative values
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
-    std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
+    // per original matrix value) Two matrices exist: gd+ (gd_p) and gd-
+    // (gd_m) The input is also split into positive and negative values
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+    const PackedGemv *packed = weights_->packed.get();
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
+    const SparsePattern *sparse =
+        sparse_d(t_off + tmp_size, col_off, n_matrix);
+
+    // (gd+ - gd-) * vd+ - (gd+ - gd-) * vd- = (gd+ - gd-) * vec
+    if (packed) {
+        std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
+        packed->gemv(tmp_out_int_.data(), vec, t_off, tmp_size, col_off,
+                     n_matrix, packed_vec_.data());
+        int_kernel::shift_add<NUM_SEG>(res, tmp_out_int_.data(),
+                                       shift_.data(), num_seg, m_matrix);
+        return;
+    }
 
     for (size_t n = 0; n < n_matrix; ++n) {
         if (vec[n] >= 0) {
@@ -44,41 +82,32 @@ void MapperIntI::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
         }
     }
 
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_int_[t_m] += (gd_p_[t_m][n] - gd_m_[t_m][n]) * vd_p_[n];
-        }
-    }
-
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t s = 0; s < split.size(); ++s) {
-            res[m] += tmp_out_int_[m * split.size() + s] << shift_[s];
-        }
-    }
-
     std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
+    int_kernel::mac(tmp_out_int_.data(), gd_p, gd_m, vd_p_.data(), t_off,
+                    tmp_size, col_off, n_matrix, sparse);
+    int_kernel::shift_add<NUM_SEG>(res, tmp_out_int_.data(), shift_.data(),
+                                   num_seg, m_matrix);
 
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_int_[t_m] += (gd_m_[t_m][n] - gd_p_[t_m][n]) * vd_m_[n];
-        }
-    }
-
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t s = 0; s < split.size(); ++s) {
-            res[m] += tmp_out_int_[m * split.size() + s] << shift_[s];
-        }
-    }
+    std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
+    int_kernel::mac(tmp_out_int_.data(), gd_m, gd_p, vd_m_.data(), t_off,
+                    tmp_size, col_off, n_matrix, sparse);
+    int_kernel::shift_add<NUM_SEG>(res, tmp_out_int_.data(), shift_.data(),
+                                   num_seg, m_matrix);
 }
 
-void MapperIntI::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntI::a_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
+                              int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
     // per original matrix value) Two matrices exist: ia+ (ia_p_) and ia-
     // (ia_m_).
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
-    std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0);
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t i_bits = int_kernel::value_or<I_BIT>(cfg_.I_BIT);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
+    const SparsePattern *sparse =
+        sparse_a(t_off + tmp_size, col_off, n_matrix);
 
     for (size_t n = 0; n < n_matrix; ++n) {
         if (vec[n] >= 0) {
@@ -93,55 +122,27 @@ void MapperIntI::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     // For each bit in vd_p execute one MVM operation with ia_p_ and one with
     // ia_m_ For positive inputs vd_p: bit 7 is always 0 (sign bit) -> CFG.I_BIT
     // - 1 Subract both results in the analog domain
-    for (size_t i_bit = 0; i_bit < CFG.I_BIT - 1; ++i_bit) {
-        // Calculcate multiplications with negative and positive weights
-        for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-            for (size_t n = 0; n < n_matrix; ++n) {
-                tmp_out_fp_[t_m] +=
-                    (ia_p_[t_m][n] - ia_m_[t_m][n]) * ((vd_p_[n] >> i_bit) & 1);
-            }
-        }
-
-        // Addition of the partial results caused by splitted weights
-        for (size_t m = 0; m < m_matrix; ++m) {
-            for (size_t s = 0; s < split.size(); ++s) {
-                res[m] += static_cast<int32_t>(
-                    round(adc_->analog_digital_conversion(
-                              tmp_out_fp_[m * split.size() + s]) /
-                          i_step_size_[s] * std::pow(2, shift_[s]) *
-                          std::pow(2, i_bit)));
-            }
-        }
-
-        // Reset tmp_out vector
-        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0);
+    for (uint32_t i_bit = 0; i_bit < i_bits - 1; ++i_bit) {
+        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+        int_kernel::mac_bit_plane(tmp_out_fp_.data(), ia_p_, ia_m_,
+                                  vd_p_.data(), i_bit, t_off, tmp_size, col_off,
+                                  n_matrix, active_cols_.data(), sparse);
+        int_kernel::adc_shift_add<NUM_SEG>(res, tmp_out_fp_.data(), *adc_,
+                                           i_step_size_.data(), shift_.data(),
+                                           num_seg, i_bit, m_matrix);
     }
 
     // For each bit in vd_m execute one MVM operation with ia_p_ and one with
     // ia_m_ Subract both results in the analog domain
-    for (size_t i_bit = 0; i_bit < CFG.I_BIT; ++i_bit) {
-        // Calculcate multiplications with negative and positive weights
-        for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-            for (size_t n = 0; n < n_matrix; ++n) {
-                tmp_out_fp_[t_m] +=
-                    (ia_m_[t_m][n] - ia_p_[t_m][n]) * ((vd_m_[n] >> i_bit) & 1);
-            }
-        }
-
-        // Addition of the partial results caused by splitted weights
-        for (size_t m = 0; m < m_matrix; ++m) {
-            for (size_t s = 0; s < split.size(); ++s) {
-                res[m] += static_cast<int32_t>(
-                    round(adc_->analog_digital_conversion(
-                              tmp_out_fp_[m * split.size() + s]) /
-                          i_step_size_[s] * std::pow(2, shift_[s]) *
-                          std::pow(2, i_bit)));
-            }
-        }
-
-        // Reset tmp_out vector
-        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0);
+    for (uint32_t i_bit = 0; i_bit < i_bits; ++i_bit) {
+        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+        int_kernel::mac_bit_plane(tmp_out_fp_.data(), ia_m_, ia_p_,
+                                  vd_m_.data(), i_bit, t_off, tmp_size, col_off,
+                                  n_matrix, active_cols_.data(), sparse);
+        int_kernel::adc_shift_add<NUM_SEG>(res, tmp_out_fp_.data(), *adc_,
+                                           i_step_size_.data(), shift_.data(),
+                                           num_seg, i_bit, m_matrix);
     }
 }
 
-} // namespace nq
\ No newline at end of file
+} // namespace nq
@@ -7,117 +7,120 @@
  ******************************************************************************/
 #include "mapping/int_mapper/int_iii.h"
 #include "helper/config.h"
+#include "mapping/int_mapper/int_kernel.h"
 
 namespace nq {
 
-MapperIntIII::MapperIntIII() :
-    vd_p_(CFG.N, 0), tmp_out_int_(CFG.M * CFG.SPLIT.size(), 0),
-    tmp_out_fp_(CFG.M * CFG.SPLIT.size(), 0.0), Mapper(true) {}
+MapperIntIII::MapperIntIII(const Config &cfg,
+                           std::shared_ptr<ProgrammedWeights> weights) :
+    vd_p_(cfg.N, 0), tmp_out_int_(cfg.M * cfg.SPLIT.size(), 0),
+    tmp_out_fp_(cfg.M * cfg.SPLIT.size(), 0.0),
+    Mapper(cfg, true, std::move(weights)) {
+    dispatch_kernel([this](auto num_seg, auto i_bit) {
+        d_mvm_ = &MapperIntIII::d_mvm_kernel<num_seg(), i_bit()>;
+        a_mvm_ = &MapperIntIII::a_mvm_kernel<num_seg(), i_bit()>;
+    });
+}
 
 MapperIntIII::~MapperIntIII() {}
 
-void MapperIntIII::d_write(const int32_t *mat, int32_t m_matrix,
-                           int32_t n_matrix) {
-    d_write_diff(mat, m_matrix, n_matrix);
+void MapperIntIII::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                           int32_t m_matrix, int32_t n_matrix) {
+    d_write_diff(mat, row_off, col_off, m_matrix, n_matrix);
 }
 
-void MapperIntIII::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p_m(m_matrix, n_matrix);
+void MapperIntIII::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                           int32_t n_end) {
+    a_write_p_m(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperIntIII::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                         int32_t m_matrix, int32_t n_matrix) {
+                         int32_t row_off, int32_t col_off, int32_t m_matrix,
+                         int32_t n_matrix) {
+    (this->*d_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+void MapperIntIII::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
+                         int32_t row_off, int32_t col_off, int32_t m_matrix,
+                         int32_t n_matrix) {
+    (this->*a_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntIII::d_mvm_kernel(int32_t *res, const int32_t *vec,
+                                int32_t row_off, int32_t col_off,
+                                int32_t m_matrix, int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
-    // per original matrix value) Two matrices exist: gd+ (gd_p_) and gd-
-    // (gd_m_) In this case, the input values (which are signed) are interpreted
+    // per original matrix value) Two matrices exist: gd+ (gd_p) and gd-
+    // (gd_m) In this case, the input values (which are signed) are interpreted
     // as two's complement
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+    const PackedGemv *packed = weights_->packed.get();
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t i_bits = int_kernel::value_or<I_BIT>(cfg_.I_BIT);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
+    const SparsePattern *sparse =
+        sparse_d(t_off + tmp_size, col_off, n_matrix);
     std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
 
-    // Use positive part only
-    uint32_t mask = (1 << (CFG.I_BIT - 1)) - 1; // mask(8) = 0b01111111
-    for (size_t n = 0; n < n_matrix; ++n) {
-        vd_p_[n] = mask & vec[n];
-    }
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_int_[t_m] += (gd_p_[t_m][n] - gd_m_[t_m][n]) * vd_p_[n];
-        }
-    }
-
-    // Use negative part (MSB of input)
-    mask = 1 << (CFG.I_BIT - 1); // mask(8) = 0b10000000
+    // Use positive part only minus the negative part (MSB of input)
+    // mask(8) = 0b01111111, msb(8) = 0b10000000
+    const uint32_t mask = (1 << (i_bits - 1)) - 1;
+    const uint32_t msb = 1 << (i_bits - 1);
     for (size_t n = 0; n < n_matrix; ++n) {
-        vd_p_[n] = mask & vec[n];
+        vd_p_[n] = static_cast<int32_t>(mask & vec[n]) -
+                   static_cast<int32_t>(msb & vec[n]);
     }
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_int_[t_m] -= (gd_p_[t_m][n] - gd_m_[t_m][n]) * vd_p_[n];
-        }
+    if (packed) {
+        packed->gemv(tmp_out_int_.data(), vd_p_.data(), t_off, tmp_size,
+                     col_off, n_matrix, packed_vec_.data());
+    } else {
+        int_kernel::mac(tmp_out_int_.data(), gd_p, gd_m, vd_p_.data(), t_off,
+                        tmp_size, col_off, n_matrix, sparse);
     }
 
     // Add sums caused by splitted weights
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t s = 0; s < split.size(); ++s) {
-            res[m] += tmp_out_int_[m * split.size() + s] << shift_[s];
-        }
-    }
+    int_kernel::shift_add<NUM_SEG>(res, tmp_out_int_.data(), shift_.data(),
+                                   num_seg, m_matrix);
 }
 
-void MapperIntIII::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                         int32_t m_matrix, int32_t n_matrix) {
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntIII::a_mvm_kernel(int32_t *res, const int32_t *vec,
+                                int32_t row_off, int32_t col_off,
+                                int32_t m_matrix, int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
     // per original matrix value) Two matrices exist: ia+ (ia_p_) and ia-
     // (ia_m_).
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
-    std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t i_bits = int_kernel::value_or<I_BIT>(cfg_.I_BIT);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
+    const SparsePattern *sparse =
+        sparse_a(t_off + tmp_size, col_off, n_matrix);
 
     // For each bit in vec execute one MVM operation with ia_p_ and one with
     // ia_m_ Execute all multiplications with all positive interpreted inputs
     // first.
-    for (size_t i_bit = 0; i_bit < CFG.I_BIT - 1; ++i_bit) {
-        // Calculcate multiplications with negative and positive weights
-        for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-            for (size_t n = 0; n < n_matrix; ++n) {
-                tmp_out_fp_[t_m] +=
-                    (ia_p_[t_m][n] - ia_m_[t_m][n]) * ((vec[n] >> i_bit) & 1);
-            }
-        }
-
-        // Addition of the partial results caused by splitted weights
-        for (size_t m = 0; m < m_matrix; ++m) {
-            for (size_t s = 0; s < split.size(); ++s) {
-                res[m] += static_cast<int32_t>(
-                    round(adc_->analog_digital_conversion(
-                              tmp_out_fp_[m * split.size() + s]) /
-                          i_step_size_[s] * std::pow(2, shift_[s]) *
-                          std::pow(2, i_bit)));
-            }
-        }
-
-        // Reset tmp_out vector
-        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0);
+    for (uint32_t i_bit = 0; i_bit < i_bits - 1; ++i_bit) {
+        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+        int_kernel::mac_bit_plane(tmp_out_fp_.data(), ia_p_, ia_m_, vec, i_bit,
+                                  t_off, tmp_size, col_off, n_matrix,
+                                  active_cols_.data(), sparse);
+        int_kernel::adc_shift_add<NUM_SEG>(res, tmp_out_fp_.data(), *adc_,
+                                           i_step_size_.data(), shift_.data(),
+                                           num_seg, i_bit, m_matrix);
     }
 
     // Execute "negative MVM" for the sign bit of vec at pos CFG.I_BIT - 1
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_fp_[t_m] += (ia_p_[t_m][n] - ia_m_[t_m][n]) *
-                                ((vec[n] >> (CFG.I_BIT - 1)) & 1);
-        }
-    }
-    // Addition of the partial results caused by splitted weights
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t s = 0; s < split.size(); ++s) {
-            res[m] -= static_cast<int32_t>(
-                round(adc_->analog_digital_conversion(
-                          tmp_out_fp_[m * split.size() + s]) /
-                      i_step_size_[s] * std::pow(2, shift_[s]) *
-                      std::pow(2, CFG.I_BIT - 1)));
-        }
-    }
+    std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+    int_kernel::mac_bit_plane(tmp_out_fp_.data(), ia_p_, ia_m_, vec, i_bits - 1,
+                              t_off, tmp_size, col_off, n_matrix,
+                              active_cols_.data(), sparse);
+    int_kernel::adc_shift_add<NUM_SEG>(res, tmp_out_fp_.data(), *adc_,
+                                       i_step_size_.data(), shift_.data(),
+                                       num_seg, i_bits - 1, m_matrix, -1);
 }
 
-} // namespace nq
\ No newline at end of file
+} // namespace nq
@@ -7,44 +7,69 @@
  ******************************************************************************/
 #include "mapping/int_mapper/int_v.h"
 #include "helper/config.h"
+#include "mapping/int_mapper/int_kernel.h"
 
 namespace nq {
 
-MapperIntV::MapperIntV() :
-    tmp_out_int_(CFG.M * CFG.SPLIT.size(), 0),
-    tmp_out_fp_(CFG.M * CFG.SPLIT.size(), 0.0),
-    res_fp_(CFG.M * CFG.SPLIT.size(), 0.0), Mapper(false) {
+MapperIntV::MapperIntV(const Config &cfg,
+                       std::shared_ptr<ProgrammedWeights> weights) :
+    tmp_out_int_(cfg.M * cfg.SPLIT.size(), 0),
+    tmp_out_fp_(cfg.M * cfg.SPLIT.size(), 0.0),
+    res_fp_(cfg.M * cfg.SPLIT.size(), 0.0),
+    Mapper(cfg, false, std::move(weights)) {
     // Calculation of the delta factor
     delta_ = 0.0;
-    if (CFG.m_mode == MappingMode::I_UINT_W_OFFS) {
-        int curr_w_bit = CFG.W_BIT;
-        for (size_t i = 0; i < CFG.SPLIT.size(); ++i) {
-            shift_[i] = curr_w_bit - CFG.SPLIT[i];
-            curr_w_bit -= CFG.SPLIT[i];
-            delta_ += (1 << shift_[i]) * ((1 << CFG.SPLIT[i]) - 1);
+    if (cfg.m_mode == MappingMode::I_UINT_W_OFFS) {
+        int curr_w_bit = cfg.W_BIT;
+        for (size_t i = 0; i < cfg.SPLIT.size(); ++i) {
+            shift_[i] = curr_w_bit - cfg.SPLIT[i];
+            curr_w_bit -= cfg.SPLIT[i];
+            delta_ += (1 << shift_[i]) * ((1 << cfg.SPLIT[i]) - 1);
         }
-        delta_ = CFG.HRS / i_mm_ * delta_;
+        delta_ = cfg.HRS / i_mm_ * delta_;
     }
+    dispatch_kernel([this](auto num_seg, auto i_bit) {
+        d_mvm_ = &MapperIntV::d_mvm_kernel<num_seg(), i_bit()>;
+        a_mvm_ = &MapperIntV::a_mvm_kernel<num_seg(), i_bit()>;
+    });
 }
 
 MapperIntV::~MapperIntV() {}
 
-void MapperIntV::d_write(const int32_t *mat, int32_t m_matrix,
-                         int32_t n_matrix) {
-    d_write_offs(mat, m_matrix, n_matrix);
+void MapperIntV::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                         int32_t m_matrix, int32_t n_matrix) {
+    d_write_offs(mat, row_off, col_off, m_matrix, n_matrix);
 }
 
-void MapperIntV::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p(m_matrix, n_matrix);
+void MapperIntV::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                         int32_t n_end) {
+    a_write_p(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperIntV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    (this->*d_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+void MapperIntV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    (this->*a_mvm_)(res, vec, row_off, col_off, m_matrix, n_matrix);
+}
+
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntV::d_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
+                              int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
-    // per original matrix value) Only one matrix exist: gd+ (gd_p_) The input
+    // per original matrix value) Only one matrix exist: gd+ (gd_p) The input
     // values 'vec' are stored in int32_t and they are all positive
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const PackedGemv *packed = weights_->packed.get();
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
     std::fill(tmp_out_int_.begin(), tmp_out_int_.end(), 0);
 
     // Calculate sum over all inputs
@@ -53,30 +78,35 @@ void MapperIntV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
         inp_sum += vec[n];
     }
 
-    for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_int_[t_m] += gd_p_[t_m][n] * vec[n];
-        }
+    if (packed) {
+        packed->gemv(tmp_out_int_.data(), vec, t_off, tmp_size, col_off,
+                     n_matrix, packed_vec_.data());
+    } else {
+        int_kernel::mac(tmp_out_int_.data(), gd_p, vec, t_off, tmp_size,
+                        col_off, n_matrix);
     }
 
     // Add sums caused by splitted weights
+    int_kernel::shift_add<NUM_SEG>(res, tmp_out_int_.data(), shift_.data(),
+                                   num_seg, m_matrix);
+
+    // Subtract term of compile-time constant
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t s = 0; s < split.size(); ++s) {
-            res[m] += tmp_out_int_[m * split.size() + s] << shift_[s];
-        }
-        // Subtract term of compile-time constant
-        res[m] -= inp_sum << (CFG.W_BIT - 1);
+        res[m] -= inp_sum << (cfg_.W_BIT - 1);
     }
 }
 
-void MapperIntV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
+template <uint32_t NUM_SEG, uint32_t I_BIT>
+void MapperIntV::a_mvm_kernel(int32_t *res, const int32_t *vec, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
+                              int32_t n_matrix) {
     // The splitted matrix is of size CFG.SPLITsize*M x N (CFG.SPLITsize values
     // per original matrix value) Only one matrix exist: ia+ (ia_p_) The input
     // is already positive only
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-    const uint32_t tmp_size = m_matrix * split.size();
-    std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+    const uint32_t num_seg = int_kernel::value_or<NUM_SEG>(num_segments_);
+    const uint32_t i_bits = int_kernel::value_or<I_BIT>(cfg_.I_BIT);
+    const uint32_t tmp_size = m_matrix * num_seg;
+    const uint32_t t_off = row_off * num_seg;
     std::fill(res_fp_.begin(), res_fp_.end(), 0.0);
 
     // Calculate sum over all inputs
@@ -86,35 +116,24 @@ void MapperIntV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     // For each bit in vec execute one MVM operation with ia_p_
-    for (size_t i_bit = 0; i_bit < CFG.I_BIT; ++i_bit) {
-        for (size_t t_m = 0; t_m < tmp_size; ++t_m) {
-            for (size_t n = 0; n < n_matrix; ++n) {
-                tmp_out_fp_[t_m] += ia_p_[t_m][n] * ((vec[n] >> i_bit) & 1);
-            }
-        }
-
-        // Addition of the partial results caused by splitted weights
-        for (size_t m = 0; m < m_matrix; ++m) {
-            for (size_t s = 0; s < split.size(); ++s) {
-                // No rounding is done here, so multiply instead of shift
-                // tmp_out / i_step_size_[s] is a floating-point value
-                res_fp_[m] += static_cast<int32_t>(
-                    round(adc_->analog_digital_conversion(
-                              tmp_out_fp_[m * split.size() + s]) /
-                          i_step_size_[s] * std::pow(2, shift_[s]) *
-                          std::pow(2, i_bit)));
-            }
-        }
-
-        // Reset tmp_out vector
-        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0);
+    // No rounding is done in the accumulation, so multiply instead of shift
+    // tmp_out / i_step_size_[s] is a floating-point value
+    for (uint32_t i_bit = 0; i_bit < i_bits; ++i_bit) {
+        std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
+        int_kernel::mac_bit_plane(tmp_out_fp_.data(), ia_p_, vec, i_bit, t_off,
+                                  tmp_size, col_off, n_matrix,
+                                  active_cols_.data());
+        int_kernel::adc_shift_add<NUM_SEG>(res_fp_.data(), tmp_out_fp_.data(),
+                                           *adc_, i_step_size_.data(),
+                                           shift_.data(), num_seg, i_bit,
+                                           m_matrix);
     }
 
     // Rescaling of the results and rounding
     for (size_t m = 0; m < m_matrix; ++m) {
-        res_fp_[m] -= inp_sum * (delta_ + (1 << (CFG.W_BIT - 1)));
+        res_fp_[m] -= inp_sum * (delta_ + (1 << (cfg_.W_BIT - 1)));
         res[m] += static_cast<int32_t>(round(res_fp_[m]));
     }
 }
 
-} // namespace nq
\ No newline at end of file
+} // namespace nq
@@ -25,198 +25,323 @@
 #include "mapping/tnn_mapper/tnn_v.h"
 
 #include <algorithm>
+#include <limits>
+#include <utility>
 
 namespace nq {
 
-Mapper::Mapper(bool is_diff_weight_mapping) :
-    is_diff_weight_mapping_(is_diff_weight_mapping),
-    gd_p_(CFG.M * CFG.SPLIT.size(), std::vector<int32_t>(CFG.N, 0)),
-    gd_m_(CFG.M * CFG.SPLIT.size(), std::vector<int32_t>(CFG.N, 0)),
-    shift_(CFG.SPLIT.size(), 0), sum_w_(CFG.M, 0),
-    ia_p_(CFG.M * CFG.SPLIT.size(), std::vector<float>(CFG.N, CFG.HRS)),
-    ia_m_(CFG.M * CFG.SPLIT.size(), std::vector<float>(CFG.N, CFG.HRS)),
-    i_step_size_(CFG.SPLIT.size(), 0.0),
-    adc_(ADCFactory::createADC(CFG.adc_type)) {
-
-    if (!CFG.digital_only) {
-        i_mm_ = CFG.LRS - CFG.HRS;
-        std::random_device hrs_rd;
-        std::random_device lrs_rd;
-        std::mt19937 hrs_gen(hrs_rd());
-        std::mt19937 lrs_gen(lrs_rd());
-        hrs_var_ = std::normal_distribution<float>(0.0f, CFG.HRS_NOISE);
-        lrs_var_ = std::normal_distribution<float>(0.0f, CFG.LRS_NOISE);
-    }
-
-    if (CFG.is_int_mapping(CFG.m_mode) || (CFG.m_mode == MappingMode::TNN_IV)) {
-        int curr_w_bit = CFG.W_BIT;
-        for (size_t i = 0; i < CFG.SPLIT.size(); ++i) {
-            shift_[i] = curr_w_bit - CFG.SPLIT[i];
-            curr_w_bit -= CFG.SPLIT[i];
+Mapper::Mapper(const Config &cfg, bool is_diff_weight_mapping,
+               std::shared_ptr<ProgrammedWeights> weights) :
+    cfg_(cfg), is_diff_weight_mapping_(is_diff_weight_mapping),
+    storage_(StorageArena::create_from_config(cfg)),
+    shift_(cfg_.SPLIT.size(), 0), region_sum_w_(cfg_.M, 0), sparse_d_(false),
+    sparse_a_(false),
+    ia_p_(make_plane<float>(cfg_.M * cfg_.SPLIT.size(), cfg_.N, cfg_.HRS,
+                            storage_.get())),
+    ia_m_(make_plane<float>(cfg_.M * cfg_.SPLIT.size(), cfg_.N, cfg_.HRS,
+                            storage_.get())),
+    i_step_size_(cfg_.SPLIT.size(), 0.0),
+    adc_(ADCFactory::createADC(cfg_.adc_type, cfg_)), active_cols_(cfg_.N, 0),
+    gen_(std::random_device{}()) {
+    bool packed = false;
+    if (cfg_.is_int_mapping(cfg_.m_mode) ||
+        (cfg_.m_mode == MappingMode::TNN_IV)) {
+        int curr_w_bit = cfg_.W_BIT;
+        for (size_t i = 0; i < cfg_.SPLIT.size(); ++i) {
+            shift_[i] = curr_w_bit - cfg_.SPLIT[i];
+            curr_w_bit -= cfg_.SPLIT[i];
         }
-        num_segments_ = CFG.SPLIT.size();
+        num_segments_ = cfg_.SPLIT.size();
 
+        uint32_t max_split =
+            *std::max_element(cfg_.SPLIT.begin(), cfg_.SPLIT.end());
+        packed = cfg_.is_int_mapping(cfg_.m_mode) &&
+                 (max_split <= PackedGemv::MAX_BITS) &&
+                 (cfg_.I_BIT <= PackedGemv::MAX_BITS);
+    }
+    const bool shared = (weights != nullptr);
+    if (shared) {
+        weights_ = std::move(weights);
+    } else {
+        weights_ = std::make_shared<ProgrammedWeights>(
+            cfg_.M * cfg_.SPLIT.size(), cfg_.N, cfg_.M, packed,
+            StorageArena::create_from_config(cfg_));
+    }
+    if (packed) {
+        packed_vec_.resize(weights_->packed->stride());
+    }
+
+    init_analog();
+    if (shared) {
+        update_sparse();
+    }
+}
+
+// Parameters of the analog crossbar that depend on the cell currents
+void Mapper::init_analog() {
+    if (cfg_.digital_only) {
+        return;
+    }
+    i_mm_ = cfg_.LRS - cfg_.HRS;
+    hrs_var_ = std::normal_distribution<float>(0.0f, cfg_.HRS_NOISE);
+    lrs_var_ = std::normal_distribution<float>(0.0f, cfg_.LRS_NOISE);
+
+    if (cfg_.is_int_mapping(cfg_.m_mode) ||
+        (cfg_.m_mode == MappingMode::TNN_IV)) {
         if (is_diff_weight_mapping_) {
             for (size_t s = 0; s < num_segments_; ++s) {
-                i_step_size_[s] = i_mm_ / ((1 << (CFG.SPLIT[s] - 1)));
+                i_step_size_[s] = i_mm_ / ((1 << (cfg_.SPLIT[s] - 1)));
             }
         } else {
             for (size_t s = 0; s < num_segments_; ++s) {
-                i_step_size_[s] = i_mm_ / ((1 << CFG.SPLIT[s]) - 1);
+                i_step_size_[s] = i_mm_ / ((1 << cfg_.SPLIT[s]) - 1);
             }
         }
     }
 }
 
-std::unique_ptr<Mapper> Mapper::create_from_config() {
-    switch (CFG.m_mode) {
+void Mapper::update_adc() {
+    adc_ = ADCFactory::createADC(cfg_.adc_type, cfg_);
+}
+
+// Recompute the currents of all cells from the programmed weights, e.g.,
+// after a change of HRS, LRS or the state variability. The usability of the
+// sparse pattern for the analog MVM depends on the state variability.
+void Mapper::update_analog() {
+    init_analog();
+    a_write(0, cfg_.M, 0, cfg_.N);
+    update_sparse();
+}
+
+// Copy-on-write: the programmed weights are copied if a replica shares them
+ProgrammedWeights &Mapper::mutable_weights() {
+    if (weights_.use_count() > 1) {
+        weights_ = weights_->clone(StorageArena::create_from_config(cfg_));
+    }
+    return *weights_;
+}
+
+std::unique_ptr<Mapper>
+Mapper::create_from_config(const Config &cfg,
+                           std::shared_ptr<ProgrammedWeights> weights) {
+    switch (cfg.m_mode) {
     case MappingMode::I_DIFF_W_DIFF_1XB:
-        return std::make_unique<MapperIntI>();
+        return std::make_unique<MapperIntI>(cfg, std::move(weights));
     case MappingMode::I_DIFF_W_DIFF_2XB:
-        return std::make_unique<MapperIntI>();
+        return std::make_unique<MapperIntI>(cfg, std::move(weights));
     case MappingMode::I_OFFS_W_DIFF:
-        return std::make_unique<MapperIntII>();
+        return std::make_unique<MapperIntII>(cfg, std::move(weights));
     case MappingMode::I_TC_W_DIFF:
-        return std::make_unique<MapperIntIII>();
+        return std::make_unique<MapperIntIII>(cfg, std::move(weights));
     case MappingMode::I_UINT_W_DIFF:
-        return std::make_unique<MapperIntIV>();
+        return std::make_unique<MapperIntIV>(cfg, std::move(weights));
     case MappingMode::I_UINT_W_OFFS:
-        return std::make_unique<MapperIntV>();
+        return std::make_unique<MapperIntV>(cfg, std::move(weights));
     case MappingMode::BNN_I:
-        return std::make_unique<MapperBnnI>();
+        return std::make_unique<MapperBnnI>(cfg, std::move(weights));
     case MappingMode::BNN_II:
-        return std::make_unique<MapperBnnII>();
+        return std::make_unique<MapperBnnII>(cfg, std::move(weights));
     case MappingMode::BNN_III:
-        return std::make_unique<MapperBnnIII>();
+        return std::make_unique<MapperBnnIII>(cfg, std::move(weights));
     case MappingMode::BNN_IV:
-        return std::make_unique<MapperBnnIV>();
+        return std::make_unique<MapperBnnIV>(cfg, std::move(weights));
     case MappingMode::BNN_V:
-        return std::make_unique<MapperBnnV>();
+        return std::make_unique<MapperBnnV>(cfg, std::move(weights));
     case MappingMode::BNN_VI:
-        return std::make_unique<MapperBnnVI>();
+        return std::make_unique<MapperBnnVI>(cfg, std::move(weights));
     case MappingMode::TNN_I:
-        return std::make_unique<MapperTnnI>();
+        return std::make_unique<MapperTnnI>(cfg, std::move(weights));
     case MappingMode::TNN_II:
-        return std::make_unique<MapperTnnII>();
+        return std::make_unique<MapperTnnII>(cfg, std::move(weights));
     case MappingMode::TNN_III:
-        return std::make_unique<MapperTnnIII>();
+        return std::make_unique<MapperTnnIII>(cfg, std::move(weights));
     case MappingMode::TNN_IV:
-        return std::make_unique<MapperTnnIV>();
+        return std::make_unique<MapperTnnIV>(cfg, std::move(weights));
     case MappingMode::TNN_V:
-        return std::make_unique<MapperTnnV>();
+        return std::make_unique<MapperTnnV>(cfg, std::move(weights));
     default:
         std::cerr << "Mapper not implemented.";
         abort();
     }
 }
 
-void Mapper::d_write_diff(const int32_t *mat, int32_t m_matrix,
+// Number of weight segments of the specialized kernel (0: generic kernel)
+uint32_t Mapper::kernel_num_segments() const {
+    if (cfg_.I_BIT != 8) {
+        return 0;
+    }
+    switch (cfg_.SPLIT.size()) {
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+        return cfg_.SPLIT.size();
+    default:
+        return 0;
+    }
+}
+
+void Mapper::write(const int32_t *mat, int32_t m_matrix, int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    w.m_written = m_matrix;
+    w.n_written = n_matrix;
+    d_write(mat, 0, 0, m_matrix, n_matrix);
+}
+
+void Mapper::write_region(const int32_t *mat, int32_t row_off,
+                          int32_t col_off, int32_t m_matrix,
                           int32_t n_matrix) {
-    const std::vector<uint32_t> &split = CFG.SPLIT;
+    ProgrammedWeights &w = mutable_weights();
+    w.m_written = std::max(w.m_written, row_off + m_matrix);
+    w.n_written = std::max(w.n_written, col_off + n_matrix);
+    d_write(mat, row_off, col_off, m_matrix, n_matrix);
+}
+
+// Weight sum of the columns [n_begin, n_end) of a matrix row, decoded from
+// its programmed segments (used if a region write changes only a part of the
+// row or an MVM reads only a part of it)
+int32_t Mapper::diff_row_sum(uint32_t row, uint32_t num_seg, int32_t n_begin,
+                             int32_t n_end) const {
+    const ProgrammedWeights &w = *weights_;
+    int32_t sum = 0;
+    for (size_t s = 0; s < num_seg; ++s) {
+        const size_t gd_idx = row * num_seg + s;
+        int32_t sum_seg = 0;
+        for (size_t n = n_begin; n < n_end; ++n) {
+            sum_seg += w.gd_p[gd_idx][n] - w.gd_m[gd_idx][n];
+        }
+        sum += sum_seg * (1 << shift_[s]);
+    }
+    return sum;
+}
+
+void Mapper::d_write_diff(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    const std::vector<uint32_t> &split = cfg_.SPLIT;
+    const bool full_rows = (col_off == 0) && (n_matrix >= w.n_written);
     for (size_t m = 0; m < m_matrix; ++m) {
         int32_t sum_n = 0;
         for (size_t n = 0; n < n_matrix; ++n) {
             int mat_val = mat[n_matrix * m + n];
             sum_n += mat_val;
             for (size_t s = 0; s < split.size(); ++s) {
-                int gd_idx = m * split.size() + s;
+                int gd_idx = (row_off + m) * split.size() + s;
                 if (mat_val >= 0) {
-                    gd_p_[gd_idx][n] =
+                    w.gd_p[gd_idx][col_off + n] =
                         (mat_val >> shift_[s]) & ((1 << split[s]) - 1);
-                    gd_m_[gd_idx][n] = 0;
+                    w.gd_m[gd_idx][col_off + n] = 0;
                 } else {
-                    gd_p_[gd_idx][n] = 0;
-                    gd_m_[gd_idx][n] =
+                    w.gd_p[gd_idx][col_off + n] = 0;
+                    w.gd_m[gd_idx][col_off + n] =
                         (-mat_val >> shift_[s]) & ((1 << split[s]) - 1);
                 }
             }
         }
-        sum_w_[m] = sum_n;
+        w.sum_w[row_off + m] =
+            full_rows ? sum_n
+                      : diff_row_sum(row_off + m, split.size(), 0, w.n_written);
     }
+    if (w.packed) {
+        w.packed->pack(w.gd_p, w.gd_m, row_off * split.size(),
+                       (row_off + m_matrix) * split.size(), col_off,
+                       col_off + n_matrix);
+    }
+    build_sparse(w.m_written * split.size(), w.n_written);
 }
 
-void Mapper::d_write_diff_bnn(const int32_t *mat, int32_t m_matrix,
+void Mapper::d_write_diff_bnn(const int32_t *mat, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
                               int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    const bool full_rows = (col_off == 0) && (n_matrix >= w.n_written);
     for (size_t m = 0; m < m_matrix; ++m) {
+        const size_t row = row_off + m;
         int32_t sum_n = 0;
         for (size_t n = 0; n < n_matrix; ++n) {
             int mat_val = mat[n_matrix * m + n];
             sum_n += mat_val;
             if (mat_val == +1) {
-                gd_p_[m][n] = mat_val;
-                gd_m_[m][n] = 0;
+                w.gd_p[row][col_off + n] = mat_val;
+                w.gd_m[row][col_off + n] = 0;
             } else if (mat_val == -1) {
-                gd_p_[m][n] = 0;
-                gd_m_[m][n] = -mat_val;
+                w.gd_p[row][col_off + n] = 0;
+                w.gd_m[row][col_off + n] = -mat_val;
             } else {
                 std::cerr << "BNN weigth is neither +1 nor -1.";
                 abort();
             }
         }
-        sum_w_[m] = sum_n;
+        w.sum_w[row] = full_rows ? sum_n : diff_row_sum(row, 1, 0, w.n_written);
     }
 }
 
-void Mapper::d_write_diff_tnn(const int32_t *mat, int32_t m_matrix,
+void Mapper::d_write_diff_tnn(const int32_t *mat, int32_t row_off,
+                              int32_t col_off, int32_t m_matrix,
                               int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    const bool full_rows = (col_off == 0) && (n_matrix >= w.n_written);
     for (size_t m = 0; m < m_matrix; ++m) {
+        const size_t row = row_off + m;
         int32_t sum_n = 0;
         for (size_t n = 0; n < n_matrix; ++n) {
             int mat_val = mat[n_matrix * m + n];
             sum_n += mat_val;
             if (mat_val == +1) {
-                gd_p_[m][n] = mat_val;
-                gd_m_[m][n] = 0;
+                w.gd_p[row][col_off + n] = mat_val;
+                w.gd_m[row][col_off + n] = 0;
             } else if (mat_val == -1) {
-                gd_p_[m][n] = 0;
-                gd_m_[m][n] = -mat_val;
+                w.gd_p[row][col_off + n] = 0;
+                w.gd_m[row][col_off + n] = -mat_val;
             } else if (mat_val == 0) {
-                gd_p_[m][n] = 0;
-                gd_m_[m][n] = 0;
+                w.gd_p[row][col_off + n] = 0;
+                w.gd_m[row][col_off + n] = 0;
             } else {
                 std::cerr << "TNN weigth is neither 0 nor +1 nor -1";
                 abort();
             }
         }
-        sum_w_[m] = sum_n;
+        w.sum_w[row] = full_rows ? sum_n : diff_row_sum(row, 1, 0, w.n_written);
     }
+    build_sparse(w.m_written, w.n_written);
 }
 
-void Mapper::d_write_offs(const int32_t *mat, int32_t m_matrix,
-                          int32_t n_matrix) {
-    const std::vector<uint32_t> &split = CFG.SPLIT;
+void Mapper::d_write_offs(const int32_t *mat, int32_t row_off, int32_t col_off,
+                          int32_t m_matrix, int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    const std::vector<uint32_t> &split = cfg_.SPLIT;
     for (size_t m = 0; m < m_matrix; ++m) {
         for (size_t n = 0; n < n_matrix; ++n) {
-            int mat_val = mat[n_matrix * m + n] + (1 << (CFG.W_BIT - 1));
+            int mat_val = mat[n_matrix * m + n] + (1 << (cfg_.W_BIT - 1));
             for (size_t s = 0; s < split.size(); ++s) {
-                int gd_idx = m * split.size() + s;
-                gd_p_[gd_idx][n] =
+                int gd_idx = (row_off + m) * split.size() + s;
+                w.gd_p[gd_idx][col_off + n] =
                     (mat_val >> shift_[s]) & ((1 << split[s]) - 1);
             }
         }
     }
+    if (w.packed) {
+        w.packed->pack(w.gd_p, row_off * split.size(),
+                       (row_off + m_matrix) * split.size(), col_off,
+                       col_off + n_matrix);
+    }
 }
 
-void Mapper::d_write_tc_tnn(const int32_t *mat, int32_t m_matrix,
+void Mapper::d_write_tc_tnn(const int32_t *mat, int32_t row_off,
+                            int32_t col_off, int32_t m_matrix,
                             int32_t n_matrix, bool offset) {
-    // gd_p_ is used for bit zero (two's complement)
-    // gd_m_ is used for bit one (two's complement)
+    ProgrammedWeights &w = mutable_weights();
+    // w.gd_p is used for bit zero (two's complement)
+    // w.gd_m is used for bit one (two's complement)
     uint32_t mask_0 = 0b01;
     uint32_t mask_1 = 0b10;
-    if (CFG.SPLIT == std::vector<uint32_t>{1, 1}) {
-        if (offset) {
-            for (size_t m = 0; m < m_matrix; ++m) {
-                for (size_t n = 0; n < n_matrix; ++n) {
-                    gd_p_[m][n] = (mat[n_matrix * m + n] + 1) & mask_0;
-                    gd_m_[m][n] = ((mat[n_matrix * m + n] + 1) & mask_1) >> 1;
-                }
-            }
-        } else {
-            for (size_t m = 0; m < m_matrix; ++m) {
-                for (size_t n = 0; n < n_matrix; ++n) {
-                    gd_p_[m][n] = mat[n_matrix * m + n] & mask_0;
-                    gd_m_[m][n] = (mat[n_matrix * m + n] & mask_1) >> 1;
-                }
+    if (cfg_.SPLIT == std::vector<uint32_t>{1, 1}) {
+        const int32_t offs = offset ? 1 : 0;
+        for (size_t m = 0; m < m_matrix; ++m) {
+            for (size_t n = 0; n < n_matrix; ++n) {
+                const int32_t val = mat[n_matrix * m + n] + offs;
+                w.gd_p[row_off + m][col_off + n] = val & mask_0;
+                w.gd_m[row_off + m][col_off + n] = (val & mask_1) >> 1;
             }
         }
     } else {
@@ -224,46 +349,121 @@ void Mapper::d_write_tc_tnn(const int32_t *mat, int32_t m_matrix,
                   << std::endl;
         std::exit(EXIT_FAILURE);
     }
+    build_sparse(w.m_written, w.n_written);
+}
+
+// Build the sparse pattern of the non-HRS cells if CFG.sparse_threshold > 0
+void Mapper::build_sparse(uint32_t rows, int32_t n_matrix) {
+    ProgrammedWeights &w = mutable_weights();
+    w.sparse_dims = {rows, static_cast<uint32_t>(n_matrix)};
+    w.sparse_density = std::numeric_limits<float>::infinity();
+    if (cfg_.sparse_threshold > 0.0) {
+        w.sparse_density = w.sparse.build(w.gd_p, w.gd_m, rows, n_matrix);
+    }
+    update_sparse();
+}
+
+// Use the sparse pattern if the density is below CFG.sparse_threshold. The
+// analog MVM can use it only if HRS cells are exact (no state variability):
+// INT mappings or HRS_NOISE = 0.
+void Mapper::update_sparse() {
+    sparse_d_ = weights_->sparse_density < cfg_.sparse_threshold;
+    sparse_a_ = sparse_d_ && !cfg_.digital_only &&
+                (cfg_.is_int_mapping(cfg_.m_mode) || (cfg_.HRS_NOISE == 0.0));
+}
+
+// The pattern holds absolute columns: it can be used if it covers the cell
+// rows of the MVM and has no columns outside of the MVM
+bool Mapper::sparse_covers(uint32_t rows, int32_t col_off,
+                           int32_t n_matrix) const {
+    const std::vector<uint32_t> &dims = weights_->sparse_dims;
+    return (col_off == 0) && (rows <= dims[0]) &&
+           (static_cast<uint32_t>(n_matrix) >= dims[1]);
 }
 
-void Mapper::a_write_p_m(int32_t m_matrix, int32_t n_matrix) {
-    float hrs = CFG.HRS;
-    for (size_t m = 0; m < m_matrix * num_segments_; ++m) {
+// sum_w of the matrix rows [row_off, row_off + m_matrix) restricted to the
+// columns [col_off, col_off + n_matrix), indexed by m. The stored sums are
+// used if the MVM reads all written columns.
+const int32_t *Mapper::region_sum_w(int32_t row_off, int32_t col_off,
+                                    int32_t m_matrix, int32_t n_matrix,
+                                    uint32_t num_seg) {
+    if ((col_off == 0) && (n_matrix >= weights_->n_written)) {
+        return &weights_->sum_w[row_off];
+    }
+    for (size_t m = 0; m < m_matrix; ++m) {
+        region_sum_w_[m] =
+            diff_row_sum(row_off + m, num_seg, col_off, col_off + n_matrix);
+    }
+    return region_sum_w_.data();
+}
+
+// Current of a row for binary inputs v (num_v: number of ones in v), i and v
+// start at the first column of the MVM. With the sparse pattern, the HRS
+// cells outside of the pattern are added analytically as HRS * (number of
+// their active inputs).
+float Mapper::row_current(const float *i, const int32_t *v, int32_t num_v,
+                          uint32_t row, int32_t n_matrix,
+                          const SparsePattern *sparse) const {
+    float curr = 0.0;
+    int32_t num_v_pattern = 0;
+    for_each_col(row, n_matrix, sparse, [&](size_t n) {
+        curr += i[n] * v[n];
+        num_v_pattern += v[n];
+    });
+    if (sparse) {
+        curr += cfg_.HRS * (num_v - num_v_pattern);
+    }
+    return curr;
+}
+
+void Mapper::a_write_p_m(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                         int32_t n_end) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+    float hrs = cfg_.HRS;
+    for (size_t m = m_begin * num_segments_; m < m_end * num_segments_; ++m) {
         float step = i_step_size_[m % num_segments_];
-        for (size_t n = 0; n < n_matrix; ++n) {
-            ia_p_[m][n] = gd_p_[m][n] * step + hrs;
-            ia_m_[m][n] = gd_m_[m][n] * step + hrs;
+        for (size_t n = n_begin; n < n_end; ++n) {
+            ia_p_[m][n] = gd_p[m][n] * step + hrs;
+            ia_m_[m][n] = gd_m[m][n] * step + hrs;
         }
     }
 }
 
-void Mapper::a_write_p_m_bnn_tnn(int32_t m_matrix, int32_t n_matrix) {
-    float hrs = CFG.HRS;
-    float step = CFG.LRS - hrs;
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            ia_p_[m][n] = add_gaussian_noise(gd_p_[m][n] * step + hrs);
-            ia_m_[m][n] = add_gaussian_noise(gd_m_[m][n] * step + hrs);
+void Mapper::a_write_p_m_bnn_tnn(int32_t m_begin, int32_t m_end,
+                                 int32_t n_begin, int32_t n_end) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+    float hrs = cfg_.HRS;
+    float step = cfg_.LRS - hrs;
+    for (size_t m = m_begin; m < m_end; ++m) {
+        for (size_t n = n_begin; n < n_end; ++n) {
+            ia_p_[m][n] = add_gaussian_noise(gd_p[m][n] * step + hrs);
+            ia_m_[m][n] = add_gaussian_noise(gd_m[m][n] * step + hrs);
         }
     }
 }
 
-void Mapper::a_write_p(int32_t m_matrix, int32_t n_matrix) {
-    float hrs = CFG.HRS;
-    for (size_t m = 0; m < m_matrix * num_segments_; ++m) {
+void Mapper::a_write_p(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                       int32_t n_end) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    float hrs = cfg_.HRS;
+    for (size_t m = m_begin * num_segments_; m < m_end * num_segments_; ++m) {
         float step = i_step_size_[m % num_segments_];
-        for (size_t n = 0; n < n_matrix; ++n) {
-            ia_p_[m][n] = gd_p_[m][n] * step + hrs;
+        for (size_t n = n_begin; n < n_end; ++n) {
+            ia_p_[m][n] = gd_p[m][n] * step + hrs;
         }
     }
 }
 
-void Mapper::a_write_p_bnn(int32_t m_matrix, int32_t n_matrix) {
-    float hrs = CFG.HRS;
-    float step = CFG.LRS - hrs;
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            ia_p_[m][n] = add_gaussian_noise(gd_p_[m][n] * step + hrs);
+void Mapper::a_write_p_bnn(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                           int32_t n_end) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    float hrs = cfg_.HRS;
+    float step = cfg_.LRS - hrs;
+    for (size_t m = m_begin; m < m_end; ++m) {
+        for (size_t n = n_begin; n < n_end; ++n) {
+            ia_p_[m][n] = add_gaussian_noise(gd_p[m][n] * step + hrs);
         }
     }
 }
@@ -273,47 +473,95 @@ void Mapper::a_write_p_bnn(int32_t m_matrix, int32_t n_matrix) {
 // Current cannot be negative.
 // For BNN and TNN only
 float Mapper::add_gaussian_noise(float state) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    if (state == CFG.HRS) {
-        return std::max(state + hrs_var_(gen), 0.0f);
-    } else if (state == CFG.LRS) {
-        return std::max(state + lrs_var_(gen), 0.0f);
+    if (state == cfg_.HRS) {
+        return std::max(state + hrs_var_(gen_), 0.0f);
+    } else if (state == cfg_.LRS) {
+        return std::max(state + lrs_var_(gen_), 0.0f);
     } else {
         std::cerr << "Unexpected crossbar state: " << state << std::endl;
         std::exit(EXIT_FAILURE);
     }
 }
 
-const std::vector<std::vector<int32_t>> &Mapper::get_gd_p() const {
-    return gd_p_;
+void Mapper::save(SnapshotWriter &snapshot) const {
+    snapshot.add("gd_p", weights_->gd_p);
+    snapshot.add("gd_m", weights_->gd_m);
+    snapshot.add("sum_w", weights_->sum_w);
+    snapshot.add("written", std::vector<int32_t>{weights_->m_written,
+                                                 weights_->n_written});
+    snapshot.add("sparse_dims", weights_->sparse_dims);
+    snapshot.add("ia_p", ia_p_);
+    snapshot.add("ia_m", ia_m_);
+}
+
+// Restore the cells and rebuild the packed copy and the sparse pattern.
+// Packing all rows and columns is equivalent to packing the last written
+// matrix (the input of the GEMV is zero-padded). Snapshots without the
+// written extent (older versions) assume the full crossbar.
+bool Mapper::load(const SnapshotReader &snapshot) {
+    ProgrammedWeights &w = mutable_weights();
+    std::vector<uint32_t> sparse_dims(2, 0);
+    std::vector<int32_t> written{static_cast<int32_t>(cfg_.M),
+                                 static_cast<int32_t>(cfg_.N)};
+    if (!(snapshot.read("gd_p", w.gd_p) && snapshot.read("gd_m", w.gd_m) &&
+          snapshot.read("sum_w", w.sum_w) &&
+          snapshot.read("sparse_dims", sparse_dims) &&
+          snapshot.read("ia_p", ia_p_) && snapshot.read("ia_m", ia_m_))) {
+        return false;
+    }
+    if (snapshot.has("written") && !snapshot.read("written", written)) {
+        return false;
+    }
+    w.m_written = written[0];
+    w.n_written = written[1];
+    if (w.packed) {
+        if (is_diff_weight_mapping_) {
+            w.packed->pack(w.gd_p, w.gd_m, 0, w.gd_p.size(), 0, cfg_.N);
+        } else {
+            w.packed->pack(w.gd_p, 0, w.gd_p.size(), 0, cfg_.N);
+        }
+    }
+    if ((sparse_dims[0] > 0) && (sparse_dims[1] > 0)) {
+        build_sparse(sparse_dims[0], sparse_dims[1]);
+    } else {
+        w.sparse_dims = sparse_dims;
+        w.sparse_density = std::numeric_limits<float>::infinity();
+        update_sparse();
+    }
+    return true;
+}
+
+const Plane<int32_t> &Mapper::get_gd_p() const {
+    return weights_->gd_p;
 }
 
-const std::vector<std::vector<int32_t>> &Mapper::get_gd_m() const {
-    return gd_m_;
+const Plane<int32_t> &Mapper::get_gd_m() const {
+    return weights_->gd_m;
 }
 
-const std::vector<std::vector<float>> &Mapper::get_ia_p() const {
+const Plane<float> &Mapper::get_ia_p() const {
     return ia_p_;
 }
 
-const std::vector<std::vector<float>> &Mapper::get_ia_m() const {
+const Plane<float> &Mapper::get_ia_m() const {
     return ia_m_;
 }
 
 void Mapper::rd_update_conductance(std::shared_ptr<const ReadDisturb> rd_model,
                                    const uint64_t read_num) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+
     // Update ia_p_
-    const std::vector<std::vector<uint64_t>> &cycles_p =
-        rd_model->get_cycles_p();
+    const Plane<uint64_t> &cycles_p = rd_model->get_cycles_p();
 
     for (size_t i = 0; i < cycles_p.size(); i++) {
         for (size_t j = 0; j < cycles_p[i].size(); j++) {
-            if (gd_p_[i][j] == 1) {
+            if (gd_p[i][j] == 1) {
                 // Update the conductance value of LRS only
                 float LRS_scaling_factor =
                     rd_model->calc_G0_scaling_factor(read_num, cycles_p[i][j]);
-                ia_p_[i][j] = CFG.LRS * LRS_scaling_factor;
+                ia_p_[i][j] = cfg_.LRS * LRS_scaling_factor;
             }
         }
     }
@@ -324,35 +572,35 @@ void Mapper::rd_update_conductance(std::shared_ptr<const ReadDisturb> rd_model,
     }
 
     // Update ia_m_ as well
-    const std::vector<std::vector<uint64_t>> &cycles_m =
-        rd_model->get_cycles_m();
+    const Plane<uint64_t> &cycles_m = rd_model->get_cycles_m();
     for (size_t i = 0; i < cycles_m.size(); i++) {
         for (size_t j = 0; j < cycles_m[i].size(); j++) {
-            if (gd_m_[i][j] == 1) {
+            if (gd_m[i][j] == 1) {
                 // Update the conductance value of LRS only
                 float LRS_scaling_factor =
                     rd_model->calc_G0_scaling_factor(read_num, cycles_m[i][j]);
-                ia_m_[i][j] = CFG.LRS * LRS_scaling_factor;
+                ia_m_[i][j] = cfg_.LRS * LRS_scaling_factor;
             }
         }
     }
 }
 
-void Mapper::rd_update_conductance(
-    std::shared_ptr<const ReadDisturb> rd_model,
-    const std::vector<std::vector<uint64_t>> &consecutive_reads_p,
-    const std::vector<std::vector<uint64_t>> &consecutive_reads_m) {
+void Mapper::rd_update_conductance(std::shared_ptr<const ReadDisturb> rd_model,
+                                   const Plane<uint64_t> &consecutive_reads_p,
+                                   const Plane<uint64_t> &consecutive_reads_m) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
+
     // Update ia_p_
-    const std::vector<std::vector<uint64_t>> &cycles_p =
-        rd_model->get_cycles_p();
+    const Plane<uint64_t> &cycles_p = rd_model->get_cycles_p();
 
     for (size_t i = 0; i < cycles_p.size(); i++) {
         for (size_t j = 0; j < cycles_p[i].size(); j++) {
-            if (gd_p_[i][j] == 1) {
+            if (gd_p[i][j] == 1) {
                 // Update the conductance value of LRS only
                 float LRS_scaling_factor = rd_model->calc_G0_scaling_factor(
                     consecutive_reads_p[i][j], cycles_p[i][j]);
-                ia_p_[i][j] = CFG.LRS * LRS_scaling_factor;
+                ia_p_[i][j] = cfg_.LRS * LRS_scaling_factor;
             }
         }
     }
@@ -363,15 +611,14 @@ void Mapper::rd_update_conductance(
     }
 
     // Update ia_m_ as well
-    const std::vector<std::vector<uint64_t>> &cycles_m =
-        rd_model->get_cycles_m();
+    const Plane<uint64_t> &cycles_m = rd_model->get_cycles_m();
     for (size_t i = 0; i < cycles_m.size(); i++) {
         for (size_t j = 0; j < cycles_m[i].size(); j++) {
-            if (gd_m_[i][j] == 1) {
+            if (gd_m[i][j] == 1) {
                 // Update the conductance value of LRS only
                 float LRS_scaling_factor = rd_model->calc_G0_scaling_factor(
                     consecutive_reads_m[i][j], cycles_m[i][j]);
-                ia_m_[i][j] = CFG.LRS * LRS_scaling_factor;
+                ia_m_[i][j] = cfg_.LRS * LRS_scaling_factor;
             }
         }
     }
@@ -384,8 +631,8 @@ bool Mapper::rd_check_software_refresh(
     std::shared_ptr<const ReadDisturb> rd_model, const uint64_t read_num,
     const uint64_t write_num) {
     float tt = rd_model->calc_transition_time(write_num);
-    float t_stress = read_num * CFG.t_read;
-    if (t_stress >= CFG.read_disturb_mitigation_fp * tt) {
+    float t_stress = read_num * cfg_.t_read;
+    if (t_stress >= cfg_.read_disturb_mitigation_fp * tt) {
         return true;
     }
     return false;
@@ -393,15 +640,17 @@ bool Mapper::rd_check_software_refresh(
 
 // CELL_BASED refresh strategy for read disturb mitigation
 int Mapper::rd_cell_based_refresh(std::shared_ptr<ReadDisturb> rd_model) {
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
     // Count refresh operations
     int refresh_count = 0;
 
-    float tolerance = CFG.read_disturb_update_tolerance;
-    float lrs = CFG.LRS;
+    float tolerance = cfg_.read_disturb_update_tolerance;
+    float lrs = cfg_.LRS;
 
     for (size_t m = 0; m < ia_p_.size(); ++m) {
         for (size_t n = 0; n < ia_p_[m].size(); ++n) {
-            if (gd_p_[m][n] == 1) {
+            if (gd_p[m][n] == 1) {
                 // Cell [m][n] is LRS cell -> Check conductance
                 if ((ia_p_[m][n] < (1 - tolerance) * lrs) ||
                     (ia_p_[m][n] > (1 + tolerance) * lrs)) {
@@ -425,7 +674,7 @@ int Mapper::rd_cell_based_refresh(std::shared_ptr<ReadDisturb> rd_model) {
 
     for (size_t m = 0; m < ia_m_.size(); ++m) {
         for (size_t n = 0; n < ia_m_[m].size(); ++n) {
-            if (gd_m_[m][n] == 1) {
+            if (gd_m[m][n] == 1) {
                 // Cell [m][n] is LRS cell -> Check conductance
                 if ((ia_m_[m][n] < (1 - tolerance) * lrs) ||
                     (ia_m_[m][n] > (1 + tolerance) * lrs)) {
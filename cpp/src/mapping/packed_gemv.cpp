@@ -0,0 +1,114 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "mapping/packed_gemv.h"
+
+#include <algorithm>
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+#define PACKED_GEMV_AVX512_VNNI
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define PACKED_GEMV_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define PACKED_GEMV_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace nq {
+
+namespace {
+
+// Dot product of two int16 rows with len values (multiple of 32)
+inline int32_t dot(const int16_t *a, const int16_t *b, size_t len) {
+#if defined(PACKED_GEMV_AVX512_VNNI)
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < len; i += 32) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        acc = _mm512_dpwssd_epi32(acc, va, vb);
+    }
+    return _mm512_reduce_add_epi32(acc);
+#elif defined(PACKED_GEMV_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < len; i += 16) {
+        __m256i va =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                                _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(PACKED_GEMV_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (size_t i = 0; i < len; i += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int32_t acc = 0;
+    for (size_t i = 0; i < len; ++i) {
+        acc += static_cast<int32_t>(a[i]) * b[i];
+    }
+    return acc;
+#endif
+}
+
+} // namespace
+
+PackedGemv::PackedGemv(uint32_t rows, uint32_t cols) :
+    stride_((cols + LANES - 1) / LANES * LANES), mat_(rows * stride_, 0) {}
+
+void PackedGemv::pack(const Plane<int32_t> &g_a, const Plane<int32_t> &g_b,
+                      uint32_t r_begin, uint32_t r_end, int32_t n_begin,
+                      int32_t n_end) {
+    for (size_t r = r_begin; r < r_end; ++r) {
+        int16_t *row = &mat_[r * stride_];
+        for (size_t n = n_begin; n < n_end; ++n) {
+            row[n] = static_cast<int16_t>(g_a[r][n] - g_b[r][n]);
+        }
+    }
+}
+
+void PackedGemv::pack(const Plane<int32_t> &g, uint32_t r_begin,
+                      uint32_t r_end, int32_t n_begin, int32_t n_end) {
+    for (size_t r = r_begin; r < r_end; ++r) {
+        int16_t *row = &mat_[r * stride_];
+        for (size_t n = n_begin; n < n_end; ++n) {
+            row[n] = static_cast<int16_t>(g[r][n]);
+        }
+    }
+}
+
+void PackedGemv::gemv(int32_t *tmp, const int32_t *vec, uint32_t row_off,
+                      uint32_t rows, int32_t col_off, int32_t n_matrix,
+                      int16_t *vec_buf) const {
+    // The dot products start at the lane block of col_off. Other columns of
+    // the packed rows (e.g., other matrices or stale values of a larger
+    // matrix) are cancelled by the zero padding of the input.
+    const size_t begin = col_off / LANES * LANES;
+    const size_t end = (col_off + n_matrix + LANES - 1) / LANES * LANES;
+    std::fill(vec_buf + begin, vec_buf + col_off, 0);
+    std::copy(vec, vec + n_matrix, vec_buf + col_off);
+    std::fill(vec_buf + col_off + n_matrix, vec_buf + end, 0);
+
+    for (size_t r = 0; r < rows; ++r) {
+        tmp[r] += dot(&mat_[(row_off + r) * stride_ + begin], vec_buf + begin,
+                      end - begin);
+    }
+}
+
+} // namespace nq
@@ -0,0 +1,45 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "mapping/programmed_weights.h"
+
+#include <algorithm>
+
+namespace nq {
+
+ProgrammedWeights::ProgrammedWeights(uint32_t rows, uint32_t cols,
+                                     uint32_t m, bool packed,
+                                     std::unique_ptr<StorageArena> storage) :
+    storage(std::move(storage)),
+    gd_p(make_plane<int32_t>(rows, cols, 0, this->storage.get())),
+    gd_m(make_plane<int32_t>(rows, cols, 0, this->storage.get())),
+    sum_w(m, 0), m_written(0), n_written(0),
+    packed(packed ? std::make_unique<PackedGemv>(rows, cols) : nullptr),
+    sparse_density(1.0), sparse_dims(2, 0) {}
+
+std::unique_ptr<ProgrammedWeights>
+ProgrammedWeights::clone(std::unique_ptr<StorageArena> storage) const {
+    const uint32_t cols = gd_p.empty() ? 0 : gd_p[0].size();
+    auto w = std::make_unique<ProgrammedWeights>(
+        gd_p.size(), cols, sum_w.size(), false, std::move(storage));
+    for (size_t r = 0; r < gd_p.size(); ++r) {
+        std::copy(gd_p[r].begin(), gd_p[r].end(), w->gd_p[r].begin());
+        std::copy(gd_m[r].begin(), gd_m[r].end(), w->gd_m[r].begin());
+    }
+    w->sum_w = sum_w;
+    w->m_written = m_written;
+    w->n_written = n_written;
+    if (packed) {
+        w->packed = std::make_unique<PackedGemv>(*packed);
+    }
+    w->sparse = sparse;
+    w->sparse_density = sparse_density;
+    w->sparse_dims = sparse_dims;
+    return w;
+}
+
+} // namespace nq
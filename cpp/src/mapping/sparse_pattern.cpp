@@ -0,0 +1,32 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "mapping/sparse_pattern.h"
+
+namespace nq {
+
+float SparsePattern::build(const Plane<int32_t> &g_a, const Plane<int32_t> &g_b,
+                           uint32_t rows, int32_t n_matrix) {
+    row_ptr_.resize(rows + 1);
+    col_idx_.clear();
+    row_ptr_[0] = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t n = 0; n < n_matrix; ++n) {
+            if ((g_a[r][n] != 0) || (g_b[r][n] != 0)) {
+                col_idx_.push_back(n);
+            }
+        }
+        row_ptr_[r + 1] = col_idx_.size();
+    }
+
+    if ((rows == 0) || (n_matrix == 0)) {
+        return 0.0;
+    }
+    return static_cast<float>(col_idx_.size()) / (rows * n_matrix);
+}
+
+} // namespace nq
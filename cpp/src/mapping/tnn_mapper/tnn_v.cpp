@@ -10,32 +10,38 @@
 
 namespace nq {
 
-MapperTnnV::MapperTnnV() :
-    vd_p_(CFG.N, 0), vd_m_(CFG.N, 0), tmp_out_(CFG.M, 0.0),
-    tmp_out_fp_(CFG.M, 0.0), Mapper(false) {}
+MapperTnnV::MapperTnnV(const Config &cfg,
+                       std::shared_ptr<ProgrammedWeights> weights) :
+    vd_p_(cfg.N, 0), vd_m_(cfg.N, 0), tmp_out_(cfg.M, 0.0),
+    tmp_out_fp_(cfg.M, 0.0), Mapper(cfg, false, std::move(weights)) {
+    if (cfg.SPLIT != std::vector<uint32_t>{1, 1}) {
+        std::cerr << "Not implemented: SPLIT must be {1, 1} for TNN_V."
+                  << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
 
 MapperTnnV::~MapperTnnV() {}
 
-void MapperTnnV::d_write(const int32_t *mat, int32_t m_matrix,
-                         int32_t n_matrix) {
-    d_write_tc_tnn(mat, m_matrix, n_matrix, true);
+void MapperTnnV::d_write(const int32_t *mat, int32_t row_off, int32_t col_off,
+                         int32_t m_matrix, int32_t n_matrix) {
+    d_write_tc_tnn(mat, row_off, col_off, m_matrix, n_matrix, true);
 }
 
-void MapperTnnV::a_write(int32_t m_matrix, int32_t n_matrix) {
-    a_write_p_m_bnn_tnn(m_matrix, n_matrix);
+void MapperTnnV::a_write(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                         int32_t n_end) {
+    a_write_p_m_bnn_tnn(m_begin, m_end, n_begin, n_end);
 }
 
 void MapperTnnV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
-    const std::vector<uint32_t> &split = CFG.SPLIT;
-
-    if (split != std::vector<uint32_t>{1, 1}) {
-        std::cerr << "Not implemented: SPLIT must be {1, 1} for TNN_V."
-                  << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    const SparsePattern *sparse =
+        sparse_d(row_off + m_matrix, col_off, n_matrix);
 
     // Calculate sum over all inputs
+    const Plane<int32_t> &gd_p = weights_->gd_p;
+    const Plane<int32_t> &gd_m = weights_->gd_m;
     int64_t inp_sum = 0;
     for (size_t n = 0; n < n_matrix; ++n) {
         inp_sum += vec[n];
@@ -58,38 +64,41 @@ void MapperTnnV::d_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            res[m] += gd_p_[m][n] * (vd_p_[n] - vd_m_[n]) +
-                      (gd_m_[m][n] * (vd_p_[n] - vd_m_[n]) << 1);
-        }
+        const int32_t *g_p = gd_p[row_off + m].data() + col_off;
+        const int32_t *g_m = gd_m[row_off + m].data() + col_off;
+        for_each_col(row_off + m, n_matrix, sparse, [&](size_t n) {
+            res[m] += g_p[n] * (vd_p_[n] - vd_m_[n]) +
+                      (g_m[n] * (vd_p_[n] - vd_m_[n]) << 1);
+        });
         res[m] -= inp_sum;
     }
 }
 
 void MapperTnnV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                       int32_t m_matrix, int32_t n_matrix) {
-    const std::vector<uint32_t> &split = CFG.SPLIT;
+                       int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) {
+    const SparsePattern *sparse =
+        sparse_a(row_off + m_matrix, col_off, n_matrix);
     std::fill(tmp_out_fp_.begin(), tmp_out_fp_.end(), 0.0);
 
-    if (split != std::vector<uint32_t>{1, 1}) {
-        std::cerr << "Not implemented: SPLIT must be {1, 1} for TNN_V."
-                  << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
-
     // Calculate sum over all inputs
     int64_t inp_sum = 0;
     for (size_t n = 0; n < n_matrix; ++n) {
         inp_sum += vec[n];
     }
 
+    // Number of active inputs of vd_p_ and vd_m_
+    int32_t num_p = 0;
+    int32_t num_m = 0;
     for (size_t n = 0; n < n_matrix; ++n) {
         if (vec[n] == +1) {
             vd_p_[n] = 1;
             vd_m_[n] = 0;
+            num_p++;
         } else if (vec[n] == -1) {
             vd_m_[n] = 1;
             vd_p_[n] = 0;
+            num_m++;
         } else if (vec[n] == 0) {
             vd_m_[n] = 0;
             vd_p_[n] = 0;
@@ -100,43 +109,45 @@ void MapperTnnV::a_mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
     }
 
     // Analog correction term
-    float analog_correction = 3 * inp_sum * CFG.HRS / i_mm_;
+    float analog_correction = 3 * inp_sum * cfg_.HRS / i_mm_;
 
     // LSB weights ia_p_ ; positive input
-    std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_[m] += ia_p_[m][n] * vd_p_[n];
-        }
-        tmp_out_fp_[m] += adc_->analog_digital_conversion(tmp_out_[m]) / i_mm_;
+        tmp_out_[m] = row_current(&ia_p_[row_off + m][col_off], vd_p_.data(),
+                                  num_p, row_off + m, n_matrix, sparse);
+    }
+    adc_->convert(tmp_out_.data(), tmp_out_.data(), m_matrix);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        tmp_out_fp_[m] += tmp_out_[m] / i_mm_;
     }
 
     // LSB weights ia_p_ ; negative input
-    std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_[m] += ia_p_[m][n] * vd_m_[n];
-        }
-        tmp_out_fp_[m] -= adc_->analog_digital_conversion(tmp_out_[m]) / i_mm_;
+        tmp_out_[m] = row_current(&ia_p_[row_off + m][col_off], vd_m_.data(),
+                                  num_m, row_off + m, n_matrix, sparse);
+    }
+    adc_->convert(tmp_out_.data(), tmp_out_.data(), m_matrix);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        tmp_out_fp_[m] -= tmp_out_[m] / i_mm_;
     }
 
     // MSB weights ia_m_ ; positive input
-    std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_[m] += ia_m_[m][n] * vd_p_[n];
-        }
-        tmp_out_fp_[m] +=
-            adc_->analog_digital_conversion(tmp_out_[m]) * 2 / i_mm_;
+        tmp_out_[m] = row_current(&ia_m_[row_off + m][col_off], vd_p_.data(),
+                                  num_p, row_off + m, n_matrix, sparse);
+    }
+    adc_->convert(tmp_out_.data(), tmp_out_.data(), m_matrix);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        tmp_out_fp_[m] += tmp_out_[m] * 2 / i_mm_;
     }
 
-    std::fill(tmp_out_.begin(), tmp_out_.end(), 0.0);
     for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
-            tmp_out_[m] += ia_m_[m][n] * vd_m_[n];
-        }
-        tmp_out_fp_[m] -=
-            adc_->analog_digital_conversion(tmp_out_[m]) * 2 / i_mm_;
+        tmp_out_[m] = row_current(&ia_m_[row_off + m][col_off], vd_m_.data(),
+                                  num_m, row_off + m, n_matrix, sparse);
+    }
+    adc_->convert(tmp_out_.data(), tmp_out_.data(), m_matrix);
+    for (size_t m = 0; m < m_matrix; ++m) {
+        tmp_out_fp_[m] -= tmp_out_[m] * 2 / i_mm_;
     }
 
     for (size_t m = 0; m < m_matrix; ++m) {
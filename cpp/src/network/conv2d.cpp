@@ -0,0 +1,140 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "network/conv2d.h"
+#include "helper/config.h"
+
+#include <algorithm>
+
+namespace nq {
+
+bool Conv2dParams::is_valid() const {
+    return (in_channels > 0) && (in_h > 0) && (in_w > 0) &&
+           (out_channels > 0) && (kernel_h > 0) && (kernel_w > 0) &&
+           (stride_h > 0) && (stride_w > 0) && (pad_h >= 0) && (pad_w >= 0) &&
+           (dilation_h > 0) && (dilation_w > 0) && (groups > 0) &&
+           (in_channels % groups == 0) && (out_channels % groups == 0) &&
+           (out_h() > 0) && (out_w() > 0);
+}
+
+Conv2dLayer::Conv2dLayer(const Config &cfg, const std::string &name,
+                         const int32_t *weights, const Conv2dParams &params,
+                         std::vector<int32_t> bias, std::vector<float> scale,
+                         int32_t out_min, int32_t out_max) :
+    Layer(name, params.in_channels * params.in_h * params.in_w,
+          params.out_channels * params.out_h() * params.out_w(),
+          params.out_channels, std::move(bias), std::move(scale), out_min,
+          out_max),
+    params_(params) {
+    const int32_t tile_m = cfg.M;
+    const int32_t tile_n = cfg.N;
+    const int32_t group_m = params.out_channels / params.groups;
+    const int32_t group_n = params.patch_size();
+    const int32_t groups_per_block =
+        std::max(1, std::min(tile_m / group_m, tile_n / group_n));
+
+    for (int32_t g = 0; g < params.groups; g += groups_per_block) {
+        GroupBlock block;
+        block.first_group = g;
+        block.num_groups = std::min(groups_per_block, params.groups - g);
+
+        // Block-diagonal matrix of the groups
+        const int32_t m_block = block.num_groups * group_m;
+        const int32_t n_block = block.num_groups * group_n;
+        std::vector<int32_t> mat(static_cast<size_t>(m_block) * n_block, 0);
+        for (int32_t i = 0; i < block.num_groups; ++i) {
+            for (int32_t r = 0; r < group_m; ++r) {
+                const int32_t *src =
+                    weights +
+                    static_cast<size_t>((g + i) * group_m + r) * group_n;
+                std::copy(src, src + group_n,
+                          mat.begin() +
+                              static_cast<size_t>(i * group_m + r) * n_block +
+                              i * group_n);
+            }
+        }
+        block.weights =
+            std::make_unique<TiledMatrix>(cfg, mat.data(), m_block, n_block);
+        blocks_.push_back(std::move(block));
+    }
+}
+
+void Conv2dLayer::gather_patch(const int32_t *in, int32_t oy, int32_t ox,
+                               const GroupBlock &block, int32_t *patch) const {
+    const Conv2dParams &p = params_;
+    const int32_t group_channels = p.in_channels / p.groups;
+    const int32_t first_channel = block.first_group * group_channels;
+    const int32_t num_channels = block.num_groups * group_channels;
+
+    // Patch layout: channel, kernel row, kernel column (zero padding)
+    for (int32_t c = 0; c < num_channels; ++c) {
+        const int32_t *in_c =
+            in + static_cast<size_t>(first_channel + c) * p.in_h * p.in_w;
+        for (int32_t ky = 0; ky < p.kernel_h; ++ky) {
+            const int32_t iy = oy * p.stride_h - p.pad_h + ky * p.dilation_h;
+            for (int32_t kx = 0; kx < p.kernel_w; ++kx) {
+                const int32_t ix =
+                    ox * p.stride_w - p.pad_w + kx * p.dilation_w;
+                const bool inside =
+                    (iy >= 0) && (iy < p.in_h) && (ix >= 0) && (ix < p.in_w);
+                *patch++ = inside ? in_c[iy * p.in_w + ix] : 0;
+            }
+        }
+    }
+}
+
+void Conv2dLayer::forward(const int32_t *in, int32_t batch, int32_t *acc,
+                          TaskScheduler *scheduler) {
+    const int32_t out_w = params_.out_w();
+    const int32_t out_pixels = params_.out_h() * out_w;
+    const int32_t group_m = params_.out_channels / params_.groups;
+
+    // Output pixels whose patches are gathered at a time: one without
+    // parallelism, PIXELS_PER_TASK per thread with a scheduler
+    int32_t chunk = 1;
+    if ((scheduler != nullptr) && (scheduler->num_threads() > 1)) {
+        chunk = std::min<int32_t>(
+            out_pixels, scheduler->num_threads() * PIXELS_PER_TASK);
+    }
+
+    std::vector<int32_t> patches;
+    std::vector<int32_t> res;
+    for (int32_t b = 0; b < batch; ++b) {
+        const int32_t *in_b = in + static_cast<size_t>(b) * in_size_;
+        int32_t *acc_b = acc + static_cast<size_t>(b) * out_size_;
+        for (const GroupBlock &block : blocks_) {
+            const int32_t cols = block.weights->cols();
+            const int32_t rows = block.weights->rows();
+            int32_t *out = acc_b + static_cast<size_t>(block.first_group) *
+                                       group_m * out_pixels;
+            patches.resize(static_cast<size_t>(chunk) * cols);
+            for (int32_t first = 0; first < out_pixels; first += chunk) {
+                const int32_t num = std::min(chunk, out_pixels - first);
+                for (int32_t i = 0; i < num; ++i) {
+                    const int32_t pixel = first + i;
+                    int32_t *patch =
+                        patches.data() + static_cast<size_t>(i) * cols;
+                    gather_patch(in_b, pixel / out_w, pixel % out_w, block,
+                                 patch);
+                }
+                res.assign(static_cast<size_t>(num) * rows, 0);
+                block.weights->mvm_batch(res.data(), patches.data(), num,
+                                         scheduler);
+
+                // Scatter the output channels of the pixels (CHW layout)
+                for (int32_t i = 0; i < num; ++i) {
+                    for (int32_t r = 0; r < rows; ++r) {
+                        out[static_cast<size_t>(r) * out_pixels + first + i] +=
+                            res[static_cast<size_t>(i) * rows + r];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace nq
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "network/layer.h"
+#include "helper/config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace nq {
+
+TiledMatrix::TiledMatrix(const Config &cfg, const int32_t *mat,
+                         int32_t m_matrix, int32_t n_matrix) :
+    m_matrix_(m_matrix), n_matrix_(n_matrix) {
+    const int32_t tile_m = cfg.M;
+    const int32_t tile_n = cfg.N;
+    for (int32_t row = 0; row < m_matrix; row += tile_m) {
+        for (int32_t col = 0; col < n_matrix; col += tile_n) {
+            Tile tile;
+            tile.row = row;
+            tile.col = col;
+            tile.m = std::min(tile_m, m_matrix - row);
+            tile.n = std::min(tile_n, n_matrix - col);
+            tile.mat.resize(static_cast<size_t>(tile.m) * tile.n);
+            for (int32_t m = 0; m < tile.m; ++m) {
+                const int32_t *src =
+                    mat + static_cast<size_t>(row + m) * n_matrix + col;
+                std::copy(src, src + tile.n, tile.mat.begin() + m * tile.n);
+            }
+            tile.xbar = std::make_unique<Crossbar>(cfg);
+            tile.xbar->write(tile.mat.data(), tile.m, tile.n);
+            tiles_.push_back(std::move(tile));
+        }
+    }
+}
+
+void TiledMatrix::mvm(int32_t *res, const int32_t *vec) {
+    for (Tile &tile : tiles_) {
+        tile.xbar->mvm(res + tile.row, vec + tile.col, tile.mat.data(), tile.m,
+                       tile.n);
+    }
+}
+
+void TiledMatrix::mvm_batch(int32_t *res, const int32_t *vec, int32_t batch,
+                            TaskScheduler *scheduler) {
+    if ((scheduler == nullptr) || (scheduler->num_threads() == 1)) {
+        for (int32_t b = 0; b < batch; ++b) {
+            mvm(res + static_cast<size_t>(b) * m_matrix_,
+                vec + static_cast<size_t>(b) * n_matrix_);
+        }
+        return;
+    }
+
+    std::vector<std::vector<int32_t>> partials(tiles_.size());
+    for (size_t t = 0; t < tiles_.size(); ++t) {
+        partials[t].assign(static_cast<size_t>(batch) * tiles_[t].m, 0);
+    }
+
+    // The next chunk of a tile is spawned by the previous one
+    const int32_t chunk =
+        (batch + scheduler->num_threads() - 1) / scheduler->num_threads();
+    std::function<void(size_t, int32_t)> run_chunk = [&](size_t t,
+                                                         int32_t first) {
+        Tile &tile = tiles_[t];
+        const int32_t last = std::min(first + chunk, batch);
+        for (int32_t b = first; b < last; ++b) {
+            tile.xbar->mvm(partials[t].data() +
+                               static_cast<size_t>(b) * tile.m,
+                           vec + static_cast<size_t>(b) * n_matrix_ + tile.col,
+                           tile.mat.data(), tile.m, tile.n);
+        }
+        if (last < batch) {
+            scheduler->spawn([&run_chunk, t, last] { run_chunk(t, last); });
+        }
+    };
+
+    std::vector<TaskScheduler::Task> tasks;
+    for (size_t t = 0; t < tiles_.size(); ++t) {
+        tasks.push_back([&run_chunk, t] { run_chunk(t, 0); });
+    }
+    scheduler->run(std::move(tasks));
+
+    for (int32_t b = 0; b < batch; ++b) {
+        int32_t *res_b = res + static_cast<size_t>(b) * m_matrix_;
+        for (size_t t = 0; t < tiles_.size(); ++t) {
+            const Tile &tile = tiles_[t];
+            const int32_t *partial =
+                partials[t].data() + static_cast<size_t>(b) * tile.m;
+            for (int32_t i = 0; i < tile.m; ++i) {
+                res_b[tile.row + i] += partial[i];
+            }
+        }
+    }
+}
+
+Layer::Layer(const std::string &name, int32_t in_size, int32_t out_size,
+             int32_t out_channels, std::vector<int32_t> bias,
+             std::vector<float> scale, int32_t out_min, int32_t out_max) :
+    name_(name), in_size_(in_size), out_size_(out_size),
+    channel_size_(out_size / out_channels), bias_(std::move(bias)),
+    scale_(std::move(scale)), out_min_(out_min), out_max_(out_max) {}
+
+float Layer::channel_scale(int32_t i) const {
+    return (scale_.size() == 1) ? scale_[0] : scale_[i / channel_size_];
+}
+
+int32_t Layer::channel_bias(int32_t i) const {
+    return bias_.empty() ? 0 : bias_[i / channel_size_];
+}
+
+void Layer::requantize(const int32_t *acc, int32_t batch, int32_t *out) const {
+    for (int32_t i = 0; i < out_size_; ++i) {
+        const int32_t bias = channel_bias(i);
+        const double scale = channel_scale(i);
+        for (int32_t b = 0; b < batch; ++b) {
+            const size_t idx = static_cast<size_t>(b) * out_size_ + i;
+            const long val = std::lround((acc[idx] + bias) * scale);
+            out[idx] = static_cast<int32_t>(
+                std::clamp<long>(val, out_min_, out_max_));
+        }
+    }
+}
+
+void Layer::dequantize(const int32_t *acc, int32_t batch, float *out) const {
+    for (int32_t i = 0; i < out_size_; ++i) {
+        const int32_t bias = channel_bias(i);
+        const float scale = channel_scale(i);
+        for (int32_t b = 0; b < batch; ++b) {
+            const size_t idx = static_cast<size_t>(b) * out_size_ + i;
+            out[idx] = (acc[idx] + bias) * scale;
+        }
+    }
+}
+
+DenseLayer::DenseLayer(const Config &cfg, const std::string &name,
+                       const int32_t *weights, int32_t out_features,
+                       int32_t in_features, std::vector<int32_t> bias,
+                       std::vector<float> scale, int32_t out_min,
+                       int32_t out_max) :
+    Layer(name, in_features, out_features, out_features, std::move(bias),
+          std::move(scale), out_min, out_max),
+    weights_(cfg, weights, out_features, in_features) {}
+
+void DenseLayer::forward(const int32_t *in, int32_t batch, int32_t *acc,
+                         TaskScheduler *scheduler) {
+    weights_.mvm_batch(acc, in, batch, scheduler);
+}
+
+} // namespace nq
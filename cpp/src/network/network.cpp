@@ -0,0 +1,145 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "network/network.h"
+
+#include <iostream>
+
+namespace nq {
+
+Network::Network(const Config &cfg) : cfg_(cfg.clone()) {}
+
+Network::~Network() {}
+
+int32_t Network::in_size() const {
+    return layers_.empty() ? 0 : layers_.front()->in_size();
+}
+
+int32_t Network::out_size() const {
+    return layers_.empty() ? 0 : layers_.back()->out_size();
+}
+
+bool Network::check_layer(const std::string &name, int32_t in_size,
+                          int32_t out_channels, const float *scale,
+                          int32_t num_scales, int32_t out_min,
+                          int32_t out_max) const {
+    if (!layers_.empty() && (in_size != out_size())) {
+        std::cerr << "Layer " << name << ": input size " << in_size
+                  << " does not match the output size " << out_size()
+                  << " of the previous layer." << std::endl;
+        return false;
+    }
+    if ((scale == nullptr) ||
+        ((num_scales != 1) && (num_scales != out_channels))) {
+        std::cerr << "Layer " << name
+                  << ": one scale or one scale per output channel expected."
+                  << std::endl;
+        return false;
+    }
+    if (out_min > out_max) {
+        std::cerr << "Layer " << name << ": out_min > out_max." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Network::add_dense(const std::string &name, const int32_t *weights,
+                        int32_t out_features, int32_t in_features,
+                        const int32_t *bias, const float *scale,
+                        int32_t num_scales, int32_t out_min, int32_t out_max) {
+    if ((weights == nullptr) || (out_features <= 0) || (in_features <= 0)) {
+        std::cerr << "Layer " << name << ": invalid weights." << std::endl;
+        return false;
+    }
+    if (!check_layer(name, in_features, out_features, scale, num_scales,
+                     out_min, out_max)) {
+        return false;
+    }
+
+    layers_.push_back(std::make_unique<DenseLayer>(
+        *cfg_, name, weights, out_features, in_features,
+        (bias == nullptr) ? std::vector<int32_t>()
+                          : std::vector<int32_t>(bias, bias + out_features),
+        std::vector<float>(scale, scale + num_scales), out_min, out_max));
+    return true;
+}
+
+bool Network::add_conv2d(const std::string &name, const int32_t *weights,
+                         const Conv2dParams &params, const int32_t *bias,
+                         const float *scale, int32_t num_scales,
+                         int32_t out_min, int32_t out_max) {
+    if ((weights == nullptr) || !params.is_valid()) {
+        std::cerr << "Layer " << name << ": invalid convolution parameters."
+                  << std::endl;
+        return false;
+    }
+    if (!check_layer(name, params.in_channels * params.in_h * params.in_w,
+                     params.out_channels, scale, num_scales, out_min,
+                     out_max)) {
+        return false;
+    }
+
+    layers_.push_back(std::make_unique<Conv2dLayer>(
+        *cfg_, name, weights, params,
+        (bias == nullptr)
+            ? std::vector<int32_t>()
+            : std::vector<int32_t>(bias, bias + params.out_channels),
+        std::vector<float>(scale, scale + num_scales), out_min, out_max));
+    return true;
+}
+
+void Network::set_num_threads(uint32_t num_threads) {
+    scheduler_ = (num_threads == 1)
+                     ? nullptr
+                     : std::make_unique<TaskScheduler>(num_threads);
+}
+
+bool Network::check_inputs(const int32_t *inputs, int32_t batch,
+                           const float *logits) const {
+    if (layers_.empty() || (inputs == nullptr) || (logits == nullptr) ||
+        (batch <= 0)) {
+        std::cerr << "Invalid network inputs." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Network::run(const int32_t *inputs, int32_t batch, float *logits) {
+    if (!check_inputs(inputs, batch, logits)) {
+        return false;
+    }
+
+    std::vector<int32_t> act(inputs,
+                             inputs + static_cast<size_t>(batch) * in_size());
+    std::vector<int32_t> acc;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        Layer &layer = *layers_[l];
+        acc.assign(static_cast<size_t>(batch) * layer.out_size(), 0);
+        layer.forward(act.data(), batch, acc.data(), scheduler_.get());
+        if (l + 1 < layers_.size()) {
+            act.resize(acc.size());
+            layer.requantize(acc.data(), batch, act.data());
+        } else {
+            layer.dequantize(acc.data(), batch, logits);
+        }
+    }
+    return true;
+}
+
+bool Network::run_pipelined(const int32_t *inputs, int32_t batch,
+                            float *logits, size_t queue_depth) {
+    if (!check_inputs(inputs, batch, logits)) {
+        return false;
+    }
+
+    Pipeline pipeline(layers_, queue_depth);
+    pipeline.run(inputs, batch, logits);
+    stage_stats_ = pipeline.stats();
+    return true;
+}
+
+} // namespace nq
@@ -0,0 +1,98 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "network/pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace nq {
+
+Pipeline::Pipeline(std::vector<std::unique_ptr<Layer>> &layers,
+                   size_t queue_depth) :
+    layers_(layers), stats_(layers.size()) {
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        queues_.push_back(std::make_unique<SpscQueue<Activation>>(
+            std::max<size_t>(queue_depth, 1)));
+        stats_[l].name = layers_[l]->name();
+    }
+}
+
+void Pipeline::run(const int32_t *inputs, int32_t batch, float *logits) {
+    for (StageStats &stats : stats_) {
+        stats.items = 0;
+        stats.busy_s = 0.0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        workers.emplace_back([this, l, logits] { run_stage(l, logits); });
+    }
+
+    // Feed the inputs into the first stage
+    const int32_t in_size = layers_.front()->in_size();
+    for (int32_t b = 0; b < batch; ++b) {
+        const int32_t *in = inputs + static_cast<size_t>(b) * in_size;
+        queues_.front()->push({b, std::vector<int32_t>(in, in + in_size)});
+    }
+    queues_.front()->push({-1, {}});
+
+    for (auto &w : workers) {
+        w.join();
+    }
+    const std::chrono::duration<double> runtime =
+        std::chrono::steady_clock::now() - start;
+    for (StageStats &stats : stats_) {
+        stats.occupancy =
+            (runtime.count() > 0.0) ? stats.busy_s / runtime.count() : 0.0;
+    }
+}
+
+void Pipeline::run_stage(size_t stage, float *logits) {
+    Layer &layer = *layers_[stage];
+    const bool last = (stage + 1 == layers_.size());
+    SpscQueue<Activation> &in_queue = *queues_[stage];
+    StageStats &stats = stats_[stage];
+
+    std::vector<int32_t> acc(layer.out_size());
+    for (;;) {
+        Activation item;
+        in_queue.pop(item);
+        if (item.sample < 0) {
+            if (!last) {
+                queues_[stage + 1]->push(std::move(item));
+            }
+            break;
+        }
+
+        std::fill(acc.begin(), acc.end(), 0);
+        const auto start = std::chrono::steady_clock::now();
+        layer.forward(item.data.data(), 1, acc.data(), nullptr);
+        const std::chrono::duration<double> busy =
+            std::chrono::steady_clock::now() - start;
+        stats.busy_s += busy.count();
+        stats.items++;
+
+        // Requantization is digital, outside of the crossbar MVMs
+        if (last) {
+            layer.dequantize(acc.data(), 1,
+                             logits + static_cast<size_t>(item.sample) *
+                                          layer.out_size());
+        } else {
+            item.data.resize(layer.out_size());
+            layer.requantize(acc.data(), 1, item.data.data());
+        }
+
+        if (!last) {
+            queues_[stage + 1]->push(std::move(item));
+        }
+    }
+}
+
+} // namespace nq
@@ -0,0 +1,198 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "sweep/sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace nq {
+
+SweepEngine::SweepEngine(const Config &base,
+                         std::vector<TraceRecord> workload) :
+    base_(base), workload_(std::move(workload)), max_m_(0), max_n_(0) {
+    for (const auto &rec : workload_) {
+        max_m_ = std::max(max_m_, rec.m_matrix);
+        max_n_ = std::max(max_n_, rec.n_matrix);
+    }
+}
+
+std::vector<SweepResult>
+SweepEngine::run(const std::vector<nlohmann::json> &deltas,
+                 uint32_t num_threads) const {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    num_threads = std::min<size_t>(num_threads, deltas.size());
+
+    std::vector<SweepResult> results(deltas.size());
+    std::atomic<size_t> next_point(0);
+    auto worker = [&]() {
+        for (size_t p = next_point++; p < deltas.size(); p = next_point++) {
+            results[p] = run_point(deltas[p]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 1; t < num_threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &w : workers) {
+        w.join();
+    }
+    return results;
+}
+
+SweepResult SweepEngine::run_point(const nlohmann::json &delta) const {
+    SweepResult result = {};
+    result.delta = delta.dump();
+
+    std::unique_ptr<Config> cfg = base_.clone();
+    if (!delta.empty()) {
+        cfg->update_cfg(result.delta.c_str());
+    }
+
+    result.valid = (max_m_ <= static_cast<int64_t>(cfg->M)) &&
+                   (max_n_ <= static_cast<int64_t>(cfg->N));
+    if (!result.valid) {
+        return result;
+    }
+
+    std::vector<int32_t> res(cfg->M);
+    const int32_t *mat = nullptr; // Last copied matrix
+    uint64_t num_outputs = 0;
+    double sum_abs_err = 0.0;
+
+    // The first write is taken from the programmed crossbar of the geometry,
+    // which is programmed (or waited for) before the timed replay
+    auto rec = workload_.begin();
+    const bool first_cpy =
+        (rec != workload_.end()) && (rec->op == TraceOp::CPY);
+    const Crossbar *programmed = first_cpy ? &programmed_xbar(delta) : nullptr;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Crossbar> xbar;
+    if (first_cpy) {
+        xbar = programmed->replicate(*cfg);
+        mat = rec->mat.data();
+        result.cpy_ops++;
+        ++rec;
+    } else {
+        xbar = std::make_unique<Crossbar>(*cfg);
+    }
+
+    for (; rec != workload_.end(); ++rec) {
+        if (rec->op == TraceOp::CPY) {
+            xbar->write(rec->mat.data(), rec->m_matrix, rec->n_matrix);
+            mat = rec->mat.data();
+            result.cpy_ops++;
+            continue;
+        }
+
+        std::copy(rec->res_in.begin(), rec->res_in.end(), res.begin());
+        xbar->mvm(res.data(), rec->vec.data(), mat, rec->m_matrix,
+                  rec->n_matrix);
+        result.mvm_ops++;
+
+        bool mismatch = false;
+        for (int32_t m = 0; m < rec->m_matrix; ++m) {
+            const int64_t err =
+                std::abs(static_cast<int64_t>(res[m]) - rec->res_out[m]);
+            mismatch |= (err != 0);
+            sum_abs_err += err;
+            result.max_abs_err = std::max(result.max_abs_err, err);
+        }
+        num_outputs += rec->m_matrix;
+        result.mismatches += mismatch;
+    }
+    const std::chrono::duration<double> dt =
+        std::chrono::steady_clock::now() - start;
+    result.time_s = dt.count();
+    result.mean_abs_err = (num_outputs > 0) ? sum_abs_err / num_outputs : 0.0;
+    return result;
+}
+
+// Crossbar with the geometry of the point programmed with the first matrix
+// of the workload. The crossbar is programmed by the first point of the
+// geometry, the other points of the geometry wait for it.
+const Crossbar &
+SweepEngine::programmed_xbar(const nlohmann::json &delta) const {
+    std::unique_ptr<Config> cfg = base_.clone();
+    nlohmann::json geometry = nlohmann::json::object();
+    for (const auto &item : delta.items()) {
+        // The sparse pattern is built by the write with sparse_threshold
+        if ((Config::key_update(item.key()) == ConfigUpdate::REBUILD) ||
+            (item.key() == "sparse_threshold")) {
+            geometry[item.key()] = item.value();
+        }
+    }
+    if (!geometry.empty()) {
+        cfg->update_cfg(geometry);
+    }
+
+    ProgrammedXbar *entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(programmed_mutex_);
+        std::unique_ptr<ProgrammedXbar> &slot =
+            programmed_[cfg->fingerprint()];
+        if (slot == nullptr) {
+            slot = std::make_unique<ProgrammedXbar>();
+            slot->cfg = std::move(cfg);
+        }
+        entry = slot.get();
+    }
+
+    std::call_once(entry->once, [this, entry] {
+        const TraceRecord &rec = workload_.front();
+        entry->xbar = std::make_unique<Crossbar>(*entry->cfg);
+        entry->xbar->write(rec.mat.data(), rec.m_matrix, rec.n_matrix);
+    });
+    return *entry->xbar;
+}
+
+size_t SweepEngine::num_programmed() const {
+    std::lock_guard<std::mutex> lock(programmed_mutex_);
+    return programmed_.size();
+}
+
+bool SweepEngine::write_csv(const std::string &path,
+                            const std::vector<SweepResult> &results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot open result file: " << path << std::endl;
+        return false;
+    }
+
+    out << "point,delta,valid,cpy_ops,mvm_ops,mismatches,mean_abs_err,"
+           "max_abs_err,time_s\n";
+    for (size_t p = 0; p < results.size(); ++p) {
+        const SweepResult &r = results[p];
+        // Quote the JSON delta (quotes are escaped by doubling them)
+        std::string delta;
+        for (char c : r.delta) {
+            delta += (c == '"') ? "\"\"" : std::string(1, c);
+        }
+        out << p << ",\"" << delta << "\"," << r.valid << "," << r.cpy_ops
+            << "," << r.mvm_ops << "," << r.mismatches << ","
+            << r.mean_abs_err << "," << r.max_abs_err << "," << r.time_s
+            << "\n";
+    }
+
+    if (!out) {
+        std::cerr << "Writing result file failed: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace nq
@@ -8,79 +8,406 @@
 #include "xbar/crossbar.h"
 #include "helper/config.h"
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 namespace nq {
 
-Crossbar::Crossbar() :
-    mapper_(Mapper::create_from_config()), write_xbar_counter_(0),
-    mvm_counter_(0), rd_model_(nullptr), consecutive_mvm_counter_(0),
-    refresh_xbar_counter_(0), refresh_cell_counter_(0) {
-    if (CFG.read_disturb) {
-        rd_model_ = std::make_shared<ReadDisturb>(CFG.V_read);
+namespace {
+
+// Call f(begin, size) for each run of consecutive rows of the ascending row
+// list (rows == nullptr: one run of all m_matrix rows)
+template <typename F>
+void for_each_run(const int32_t *rows, int32_t num_rows, int32_t m_matrix,
+                  F &&f) {
+    if (rows == nullptr) {
+        f(0, m_matrix);
+        return;
+    }
+    for (int32_t i = 0; i < num_rows;) {
+        int32_t j = i + 1;
+        while ((j < num_rows) && (rows[j] == rows[j - 1] + 1)) {
+            ++j;
+        }
+        f(rows[i], j - i);
+        i = j;
+    }
+}
+
+} // namespace
+
+Crossbar::Crossbar(const Config &cfg) :
+    Crossbar(cfg, Mapper::create_from_config(cfg)) {}
+
+Crossbar::Crossbar(const Config &cfg, std::unique_ptr<Mapper> mapper) :
+    cfg_(cfg), mapper_(std::move(mapper)),
+    write_xbar_counter_(0), mvm_counter_(0), rd_model_(nullptr),
+    consecutive_mvm_counter_(0), refresh_xbar_counter_(0),
+    refresh_cell_counter_(0), digital_shortcut_(false),
+    dirty_begin_(cfg.M, 0), dirty_end_(cfg.M, 0), dirty_(false) {
+    if (cfg_.read_disturb) {
+        rd_model_ = std::make_shared<ReadDisturb>(cfg_, cfg_.V_read);
     }
+    init_adc_model();
+}
+
+void Crossbar::init_adc_model() {
+    adc_schedule_ = nullptr;
+    if (!cfg_.digital_only && (cfg_.adc_share > 0)) {
+        adc_schedule_ = std::make_unique<ADCSchedule>(
+            cfg_.M, cfg_.adc_share, cfg_.adc_mux_order, cfg_.adc_latency);
+    }
+    // The ADC telemetry and schedule need the analog MVM
+    digital_shortcut_ = false;
+    if (!cfg_.digital_only && cfg_.digital_shortcut && !cfg_.adc_telemetry &&
+        !adc_schedule_) {
+        digital_shortcut_ = is_digital_equivalent();
+    }
+}
+
+void Crossbar::reconfigure(ConfigUpdate update) {
+    if (update == ConfigUpdate::NONE) {
+        return;
+    }
+    if (update == ConfigUpdate::REBUILD) {
+        std::cerr << "Config update requires a new crossbar." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    if ((update == ConfigUpdate::ANALOG) && !cfg_.digital_only) {
+        // The read disturb state (set/reset cycles, consecutive reads) is
+        // kept unless the read disturb model changed
+        const bool rd_changed =
+            (cfg_.read_disturb != (rd_model_ != nullptr)) ||
+            (rd_model_ && (rd_model_->get_V_read() != cfg_.V_read));
+        if (rd_changed) {
+            rd_model_ = cfg_.read_disturb
+                            ? std::make_shared<ReadDisturb>(cfg_, cfg_.V_read)
+                            : nullptr;
+            consecutive_mvm_counter_ = 0;
+        }
+        mapper_->update_analog();
+        std::fill(dirty_end_.begin(), dirty_end_.end(), 0);
+        dirty_ = false;
+    }
+    mapper_->update_adc();
+    init_adc_model();
+}
+
+std::unique_ptr<Crossbar> Crossbar::replicate() const {
+    return replicate(cfg_);
+}
+
+std::unique_ptr<Crossbar> Crossbar::replicate(const Config &cfg) const {
+    // The replica allocates only its analog state, not the weight planes
+    std::unique_ptr<Crossbar> xbar(new Crossbar(cfg, mapper_->replicate(cfg)));
+    // Like one write of the shared weights (no set/reset cycles yet)
+    xbar->write_xbar_counter_ = 1;
+    if (!cfg.digital_only) {
+        xbar->mark_dirty(0, cfg.M, 0, cfg.N);
+    }
+    return xbar;
+}
+
+// Add the columns [n_begin, n_end) of the rows [m_begin, m_end) to the cells
+// to program. Each row keeps one column interval: a disjoint interval
+// programs the pending cells of the row first.
+void Crossbar::mark_dirty(int32_t m_begin, int32_t m_end, int32_t n_begin,
+                          int32_t n_end) {
+    for (int32_t m = m_begin; m < m_end; ++m) {
+        if (dirty_begin_[m] >= dirty_end_[m]) {
+            dirty_begin_[m] = n_begin;
+            dirty_end_[m] = n_end;
+        } else if ((n_begin <= dirty_end_[m]) && (n_end >= dirty_begin_[m])) {
+            dirty_begin_[m] = std::min(dirty_begin_[m], n_begin);
+            dirty_end_[m] = std::max(dirty_end_[m], n_end);
+        } else {
+            mapper_->a_write(m, m + 1, dirty_begin_[m], dirty_end_[m]);
+            dirty_begin_[m] = n_begin;
+            dirty_end_[m] = n_end;
+        }
+    }
+    dirty_ = true;
+}
+
+// Program the currents of the cells written since the last analog access,
+// rows with the same column interval are programmed together
+void Crossbar::program_analog() const {
+    if (!dirty_) {
+        return;
+    }
+    for (int32_t m = 0; m < cfg_.M;) {
+        int32_t end = m + 1;
+        while ((end < cfg_.M) && (dirty_begin_[end] == dirty_begin_[m]) &&
+               (dirty_end_[end] == dirty_end_[m])) {
+            ++end;
+        }
+        if (dirty_begin_[m] < dirty_end_[m]) {
+            mapper_->a_write(m, end, dirty_begin_[m], dirty_end_[m]);
+        }
+        m = end;
+    }
+    std::fill(dirty_end_.begin(), dirty_end_.end(), 0);
+    dirty_ = false;
+}
+
+// Check if the analog MVM of the current config is provably identical to the
+// digital MVM. This holds for an ideal crossbar (INF_ADC, no state
+// variability, no read disturb) and mappings where the HRS currents cancel in
+// the differential read-out, as long as the worst-case float rounding error of
+// the accumulated currents stays below half an LSB.
+bool Crossbar::is_digital_equivalent() const {
+    if ((cfg_.adc_type != ADCType::INF_ADC) || (cfg_.HRS_NOISE != 0.0) ||
+        (cfg_.LRS_NOISE != 0.0) || cfg_.read_disturb) {
+        return false;
+    }
+
+    switch (cfg_.m_mode) {
+    case MappingMode::I_DIFF_W_DIFF_1XB:
+    case MappingMode::I_DIFF_W_DIFF_2XB:
+    case MappingMode::I_OFFS_W_DIFF:
+    case MappingMode::I_TC_W_DIFF:
+    case MappingMode::I_UINT_W_DIFF:
+    case MappingMode::BNN_I:
+    case MappingMode::BNN_II:
+    case MappingMode::BNN_VI:
+    case MappingMode::TNN_I:
+    case MappingMode::TNN_II:
+    case MappingMode::TNN_III:
+        break;
+    default:
+        // Offset mappings subtract large HRS terms in the float domain
+        return false;
+    }
+
+    uint32_t max_split = 1;
+    if (cfg_.is_int_mapping(cfg_.m_mode)) {
+        max_split = *std::max_element(cfg_.SPLIT.begin(), cfg_.SPLIT.end());
+    }
+
+    // lsb: smallest current step resolved by the read-out
+    // i_max: largest cell current (differential segments use up to 2 * i_mm)
+    const double u = std::ldexp(1.0, -24);
+    const double i_mm = cfg_.LRS - cfg_.HRS;
+    const double lsb = i_mm / std::ldexp(1.0, max_split);
+    const double i_max = cfg_.HRS + 2 * i_mm;
+    const double n = cfg_.N;
+
+    // Rounding of the cell currents and products (up to four per column) plus
+    // recursive summation over n columns, followed by the scaling to LSBs
+    const double err = u * i_max * n * (8 + 2 * n) / lsb +
+                       2 * u * n * std::ldexp(1.0, max_split);
+    return err < 0.5;
 }
 
 void Crossbar::write(const int32_t *mat, int32_t m_matrix, int32_t n_matrix) {
+    placed_.clear();
+    program_cells(mat, 0, 0, m_matrix, n_matrix, true);
+}
+
+void Crossbar::write_region(const int32_t *mat, int32_t row_off,
+                            int32_t col_off, int32_t m_matrix,
+                            int32_t n_matrix) {
+    program_cells(mat, row_off, col_off, m_matrix, n_matrix, false);
+}
+
+// The mappers convert all activated lines once per round, i.e., each run of
+// rows has the same number of batches and each row the same number of lines
+void Crossbar::schedule_adc(const ADCBatchCount &before, int32_t row_off,
+                            int32_t m_matrix, const int32_t *rows,
+                            int32_t num_rows) {
+    const ADCBatchCount after = mapper_->get_adc_batch_count();
+    const uint64_t batches = after.batches - before.batches;
+    const uint64_t conversions = after.conversions - before.conversions;
+    uint64_t num_runs = 0;
+    uint64_t num_active = 0;
+    for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+        num_runs++;
+        num_active += m;
+    });
+    if ((batches == 0) || (num_active == 0)) {
+        adc_schedule_->begin_mvm(1);
+        adc_schedule_->end_mvm(0);
+        return;
+    }
+
+    const uint64_t rounds = batches / num_runs;
+    adc_schedule_->begin_mvm(conversions / (rounds * num_active));
+    for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+        adc_schedule_->add_rows(row_off + r, row_off + r + m);
+    });
+    adc_schedule_->end_mvm(rounds);
+}
+
+bool Crossbar::is_free(int32_t row_off, int32_t col_off, int32_t m_matrix,
+                       int32_t n_matrix) const {
+    if ((row_off + m_matrix > cfg_.M) || (col_off + n_matrix > cfg_.N)) {
+        return false;
+    }
+    for (const Region &r : placed_) {
+        if ((row_off < r.row_off + r.m_matrix) &&
+            (r.row_off < row_off + m_matrix) &&
+            (col_off < r.col_off + r.n_matrix) &&
+            (r.col_off < col_off + n_matrix)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The candidate corners are the crossbar origin and the bottom and right
+// edges of the placed regions, the first free one in row-major order is used
+bool Crossbar::place(const int32_t *mat, int32_t m_matrix, int32_t n_matrix,
+                     int32_t *row_off, int32_t *col_off) {
+    std::vector<int32_t> rows = {0};
+    std::vector<int32_t> cols = {0};
+    for (const Region &r : placed_) {
+        rows.push_back(r.row_off + r.m_matrix);
+        cols.push_back(r.col_off + r.n_matrix);
+    }
+    std::sort(rows.begin(), rows.end());
+    std::sort(cols.begin(), cols.end());
+
+    for (int32_t row : rows) {
+        for (int32_t col : cols) {
+            if (is_free(row, col, m_matrix, n_matrix)) {
+                placed_.push_back({row, col, m_matrix, n_matrix});
+                write_region(mat, row, col, m_matrix, n_matrix);
+                *row_off = row;
+                *col_off = col;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Write mat to the cells at the offsets, full: replace the written matrix.
+// Only the written cells are compared for the set-reset cycles. A full write
+// resets all consecutive reads, a region write only those of its cells
+// (the crossbar read counter keeps running).
+void Crossbar::program_cells(const int32_t *mat, int32_t row_off,
+                             int32_t col_off, int32_t m_matrix,
+                             int32_t n_matrix, bool full) {
     write_xbar_counter_++;
-    consecutive_mvm_counter_ = 0;
-    if (CFG.read_disturb) {
-        std::vector<std::vector<bool>> update_p(
-            CFG.M * CFG.SPLIT.size(), std::vector<bool>(CFG.N, false));
-        std::vector<std::vector<bool>> update_m(
-            CFG.M * CFG.SPLIT.size(), std::vector<bool>(CFG.N, false));
-
-        // Copy gd_p and gd_m before changing them
-        const std::vector<std::vector<int32_t>> prev_gd_p = mapper_->get_gd_p();
-        const std::vector<std::vector<int32_t>> prev_gd_m = mapper_->get_gd_m();
-
-        mapper_->d_write(mat, m_matrix, n_matrix);
-
-        // Get the current gd_p and gd_m after writing
-        const std::vector<std::vector<int32_t>> &curr_gd_p =
-            mapper_->get_gd_p();
-        const std::vector<std::vector<int32_t>> &curr_gd_m =
-            mapper_->get_gd_m();
-
-        // Compare the previous and current gd_p and gd_m to find updates
-        for (size_t i = 0; i < update_p.size(); i++) {
-            for (size_t j = 0; j < update_p[i].size(); j++) {
-                if (prev_gd_p[i][j] == 1 && curr_gd_p[i][j] == 0) {
-                    update_p[i][j] = true;
+    if (full) {
+        consecutive_mvm_counter_ = 0;
+    }
+    if (cfg_.read_disturb) {
+        // Read disturb supports BNN/TNN mappings only, i.e., the cell rows
+        // are the matrix rows. Copy the written cells before changing them.
+        const Plane<int32_t> &gd_p = mapper_->get_gd_p();
+        const Plane<int32_t> &gd_m = mapper_->get_gd_m();
+        std::vector<int32_t> prev_p(m_matrix * n_matrix);
+        std::vector<int32_t> prev_m(m_matrix * n_matrix);
+        for (size_t i = 0; i < m_matrix; ++i) {
+            for (size_t j = 0; j < n_matrix; ++j) {
+                prev_p[i * n_matrix + j] = gd_p[row_off + i][col_off + j];
+                prev_m[i * n_matrix + j] = gd_m[row_off + i][col_off + j];
+            }
+        }
+
+        if (full) {
+            mapper_->write(mat, m_matrix, n_matrix);
+        } else {
+            mapper_->write_region(mat, row_off, col_off, m_matrix, n_matrix);
+        }
+
+        // Update the set-reset cycles of the cells reset from 1 to 0
+        const Plane<int32_t> &curr_gd_p = mapper_->get_gd_p();
+        const Plane<int32_t> &curr_gd_m = mapper_->get_gd_m();
+        for (size_t i = 0; i < m_matrix; ++i) {
+            for (size_t j = 0; j < n_matrix; ++j) {
+                const size_t m = row_off + i;
+                const size_t n = col_off + j;
+                if (prev_p[i * n_matrix + j] == 1 && curr_gd_p[m][n] == 0) {
+                    rd_model_->update_cycle_p(m, n, 1);
                 }
-                if (prev_gd_m[i][j] == 1 && curr_gd_m[i][j] == 0) {
-                    update_m[i][j] = true;
+                if (prev_m[i * n_matrix + j] == 1 && curr_gd_m[m][n] == 0) {
+                    rd_model_->update_cycle_m(m, n, 1);
                 }
             }
         }
-        // Update the set-reset cycles for each cell
-        rd_model_->update_cycles(update_p, update_m);
 
         // Reset the consecutive reads when cell_based mitigation is used
-        if (CFG.read_disturb_mitigation_strategy ==
+        if (cfg_.read_disturb_mitigation_strategy ==
             ReadDisturbMitigationStrategy::CELL_BASED) {
-            rd_model_->reset_all_consecutive_reads();
+            if (full) {
+                rd_model_->reset_all_consecutive_reads();
+            } else {
+                for (size_t m = row_off; m < row_off + m_matrix; ++m) {
+                    for (size_t n = col_off; n < col_off + n_matrix; ++n) {
+                        rd_model_->reset_consecutive_reads_p(m, n);
+                        rd_model_->reset_consecutive_reads_m(m, n);
+                    }
+                }
+            }
         }
+    } else if (full) {
+        mapper_->write(mat, m_matrix, n_matrix);
     } else {
-        mapper_->d_write(mat, m_matrix, n_matrix);
+        mapper_->write_region(mat, row_off, col_off, m_matrix, n_matrix);
     }
-    if (!CFG.digital_only) {
-        mapper_->a_write(m_matrix, n_matrix);
+    if (!cfg_.digital_only) {
+        mark_dirty(row_off, row_off + m_matrix, col_off, col_off + n_matrix);
     }
 }
 
 void Crossbar::mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
-                   int32_t m_matrix, int32_t n_matrix) {
+                   int32_t m_matrix, int32_t n_matrix, const int32_t *rows,
+                   int32_t num_rows) {
+    mvm_region(res, vec, 0, 0, m_matrix, n_matrix, rows, num_rows);
+}
+
+// Each run of selected rows is one region MVM of the mapper, so only the
+// selected rows are computed and converted
+void Crossbar::mvm_region(int32_t *res, const int32_t *vec, int32_t row_off,
+                          int32_t col_off, int32_t m_matrix, int32_t n_matrix,
+                          const int32_t *rows, int32_t num_rows) {
     mvm_counter_++;
     consecutive_mvm_counter_++;
-    if (CFG.digital_only) {
-        mapper_->d_mvm(res, vec, mat, m_matrix, n_matrix);
+    if (cfg_.digital_only) {
+        for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+            mapper_->d_mvm(res + r, vec, nullptr, row_off + r, col_off, m,
+                           n_matrix);
+        });
+    } else if (digital_shortcut_) {
+#ifdef DEBUG_MODE
+        program_analog();
+        std::vector<int32_t> res_a(res, res + m_matrix);
+        for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+            mapper_->a_mvm(res_a.data() + r, vec, nullptr, row_off + r,
+                           col_off, m, n_matrix);
+        });
+#endif
+        for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+            mapper_->d_mvm(res + r, vec, nullptr, row_off + r, col_off, m,
+                           n_matrix);
+        });
+#ifdef DEBUG_MODE
+        if (!std::equal(res, res + m_matrix, res_a.begin())) {
+            std::cerr << "Digital shortcut differs from the analog MVM!"
+                      << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+#endif
     } else {
-        mapper_->a_mvm(res, vec, mat, m_matrix, n_matrix);
+        program_analog();
+        const ADCBatchCount adc_count = mapper_->get_adc_batch_count();
+        for_each_run(rows, num_rows, m_matrix, [&](int32_t r, int32_t m) {
+            mapper_->a_mvm(res + r, vec, nullptr, row_off + r, col_off, m,
+                           n_matrix);
+        });
+        if (adc_schedule_) {
+            schedule_adc(adc_count, row_off, m_matrix, rows, num_rows);
+        }
 
-        if (CFG.read_disturb) {
-            switch (CFG.read_disturb_mitigation_strategy) {
+        if (cfg_.read_disturb) {
+            switch (cfg_.read_disturb_mitigation_strategy) {
             case ReadDisturbMitigationStrategy::OFF:
                 // No read disturb mitigation -> Simulate effect only
-                if (consecutive_mvm_counter_ % CFG.read_disturb_update_freq ==
+                if (consecutive_mvm_counter_ % cfg_.read_disturb_update_freq ==
                     0) {
                     mapper_->rd_update_conductance(rd_model_,
                                                    consecutive_mvm_counter_);
@@ -89,7 +416,7 @@ void Crossbar::mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
 
             case ReadDisturbMitigationStrategy::SOFTWARE:
                 // Software refresh, simulate effect first
-                if (consecutive_mvm_counter_ % CFG.read_disturb_update_freq ==
+                if (consecutive_mvm_counter_ % cfg_.read_disturb_update_freq ==
                     0) {
                     // Update the conductance values
                     mapper_->rd_update_conductance(rd_model_,
@@ -106,17 +433,15 @@ void Crossbar::mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
                         // all LRS cells are reprogrammed by resetting and
                         // setting again
                         std::vector<std::vector<bool>> update_p(
-                            CFG.M * CFG.SPLIT.size(),
-                            std::vector<bool>(CFG.N, false));
+                            cfg_.M * cfg_.SPLIT.size(),
+                            std::vector<bool>(cfg_.N, false));
                         std::vector<std::vector<bool>> update_m(
-                            CFG.M * CFG.SPLIT.size(),
-                            std::vector<bool>(CFG.N, false));
+                            cfg_.M * cfg_.SPLIT.size(),
+                            std::vector<bool>(cfg_.N, false));
 
                         // Get the current gd_p and gd_m
-                        const std::vector<std::vector<int32_t>> &curr_gd_p =
-                            mapper_->get_gd_p();
-                        const std::vector<std::vector<int32_t>> &curr_gd_m =
-                            mapper_->get_gd_m();
+                        const Plane<int32_t> &curr_gd_p = mapper_->get_gd_p();
+                        const Plane<int32_t> &curr_gd_m = mapper_->get_gd_m();
 
                         for (size_t i = 0; i < update_p.size(); i++) {
                             for (size_t j = 0; j < update_p[i].size(); j++) {
@@ -140,17 +465,21 @@ void Crossbar::mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
                         consecutive_mvm_counter_ = 0;
 
                         // Reset conductance values
-                        mapper_->a_write(CFG.M, CFG.N);
+                        mapper_->a_write(0, cfg_.M, 0, cfg_.N);
                     }
                 }
                 break;
 
             case ReadDisturbMitigationStrategy::CELL_BASED:
                 // Cell-based refresh
-                // Update consecutive reads first
-                rd_model_->update_consecutive_reads(m_matrix, n_matrix);
-
-                if (consecutive_mvm_counter_ % CFG.read_disturb_update_freq ==
+                // Update consecutive reads first (activated rows only)
+                for_each_run(rows, num_rows, m_matrix,
+                             [&](int32_t r, int32_t m) {
+                                 rd_model_->update_consecutive_reads(
+                                     row_off + r, col_off, m, n_matrix);
+                             });
+
+                if (consecutive_mvm_counter_ % cfg_.read_disturb_update_freq ==
                     0) {
                     // Update the conductance values
                     mapper_->rd_update_conductance(
@@ -174,53 +503,54 @@ void Crossbar::mvm(int32_t *res, const int32_t *vec, const int32_t *mat,
 }
 
 Crossbar::~Crossbar() {
-    if (CFG.verbose) {
-        std::cout << "MappingMode: " << m_mode_to_string(CFG.m_mode)
+    if (cfg_.verbose) {
+        std::cout << "MappingMode: " << m_mode_to_string(cfg_.m_mode)
                   << std::endl;
         std::cout << "write_xbar_counter_: " << write_xbar_counter_
                   << std::endl;
         std::cout << "mvm_counter_: " << mvm_counter_ << std::endl;
+        std::cout << "digital_shortcut_: " << digital_shortcut_ << std::endl;
 
         uint64_t num_write = 0;
         uint64_t num_mvm_total = 0;
         uint64_t num_mvm_sequential = 0;
-        uint32_t cells_per_value = CFG.SPLIT.size();
+        uint32_t cells_per_value = cfg_.SPLIT.size();
 
-        switch (CFG.m_mode) {
+        switch (cfg_.m_mode) {
         case MappingMode::I_DIFF_W_DIFF_1XB:
             num_write = write_xbar_counter_;
-            num_mvm_total = mvm_counter_ * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * 2 * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * 2 * cfg_.I_BIT;
             cells_per_value *= 2;
             break;
         case MappingMode::I_DIFF_W_DIFF_2XB:
             num_write = write_xbar_counter_ * 2;
-            num_mvm_total = mvm_counter_ * 2 * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * 2 * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * cfg_.I_BIT;
             cells_per_value *= 4;
             break;
         case MappingMode::I_OFFS_W_DIFF:
             num_write = write_xbar_counter_;
-            num_mvm_total = mvm_counter_ * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * cfg_.I_BIT;
             cells_per_value *= 2;
             break;
         case MappingMode::I_TC_W_DIFF:
             num_write = write_xbar_counter_;
-            num_mvm_total = mvm_counter_ * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * cfg_.I_BIT;
             cells_per_value *= 2;
             break;
         case MappingMode::I_UINT_W_DIFF:
             num_write = write_xbar_counter_;
-            num_mvm_total = mvm_counter_ * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * cfg_.I_BIT;
             cells_per_value *= 2;
             break;
         case MappingMode::I_UINT_W_OFFS:
             num_write = write_xbar_counter_;
-            num_mvm_total = mvm_counter_ * CFG.I_BIT;
-            num_mvm_sequential = mvm_counter_ * CFG.I_BIT;
+            num_mvm_total = mvm_counter_ * cfg_.I_BIT;
+            num_mvm_sequential = mvm_counter_ * cfg_.I_BIT;
             cells_per_value *= 1;
             break;
         default:
@@ -235,37 +565,37 @@ Crossbar::~Crossbar() {
     }
 }
 
-const std::vector<std::vector<int32_t>> &Crossbar::get_gd_p() const {
+const Plane<int32_t> &Crossbar::get_gd_p() const {
     return mapper_->get_gd_p();
 }
 
-const std::vector<std::vector<int32_t>> &Crossbar::get_gd_m() const {
+const Plane<int32_t> &Crossbar::get_gd_m() const {
     return mapper_->get_gd_m();
 }
 
-const std::vector<std::vector<float>> &Crossbar::get_ia_p() const {
+const Plane<float> &Crossbar::get_ia_p() const {
+    program_analog();
     return mapper_->get_ia_p();
 }
 
-const std::vector<std::vector<float>> &Crossbar::get_ia_m() const {
+const Plane<float> &Crossbar::get_ia_m() const {
+    program_analog();
     return mapper_->get_ia_m();
 }
 
-const std::vector<std::vector<uint64_t>> &Crossbar::get_cycles_p() const {
+const Plane<uint64_t> &Crossbar::get_cycles_p() const {
     return rd_model_->get_cycles_p();
 }
 
-const std::vector<std::vector<uint64_t>> &Crossbar::get_cycles_m() const {
+const Plane<uint64_t> &Crossbar::get_cycles_m() const {
     return rd_model_->get_cycles_m();
 }
 
-const std::vector<std::vector<uint64_t>> &
-Crossbar::get_consecutive_reads_p() const {
+const Plane<uint64_t> &Crossbar::get_consecutive_reads_p() const {
     return rd_model_->get_consecutive_reads_p();
 }
 
-const std::vector<std::vector<uint64_t>> &
-Crossbar::get_consecutive_reads_m() const {
+const Plane<uint64_t> &Crossbar::get_consecutive_reads_m() const {
     return rd_model_->get_consecutive_reads_m();
 }
 
@@ -291,4 +621,101 @@ const bool Crossbar::get_rd_run_out_of_bounds() const {
     return rd_model_->get_run_out_of_bounds();
 }
 
+const ADCTelemetry *Crossbar::get_adc_telemetry() const {
+    return mapper_->get_adc_telemetry();
+}
+
+// Snapshot of the complete crossbar state (cells, read disturb state and
+// counters). A snapshot can only be loaded into a crossbar of the same config.
+// If loading fails, the crossbar is partially restored and must be rewritten.
+bool Crossbar::save(const std::string &path) const {
+    SnapshotWriter snapshot;
+    snapshot.add("mode", std::vector<uint32_t>{
+                             static_cast<uint32_t>(cfg_.m_mode),
+                             static_cast<uint32_t>(cfg_.digital_only)});
+    snapshot.add("geometry", geometry());
+    snapshot.add("counters",
+                 std::vector<uint64_t>{write_xbar_counter_, mvm_counter_,
+                                       consecutive_mvm_counter_,
+                                       refresh_xbar_counter_,
+                                       refresh_cell_counter_});
+    program_analog();
+    mapper_->save(snapshot);
+    if (rd_model_) {
+        rd_model_->save(snapshot);
+    }
+    return snapshot.write(path);
+}
+
+// Parameters that define the meaning of the state planes of a snapshot
+std::vector<uint32_t> Crossbar::geometry() const {
+    std::vector<uint32_t> geometry = {cfg_.M, cfg_.N, cfg_.W_BIT, cfg_.I_BIT};
+    geometry.insert(geometry.end(), cfg_.SPLIT.begin(), cfg_.SPLIT.end());
+    return geometry;
+}
+
+bool Crossbar::load(const std::string &path) {
+    SnapshotReader snapshot(path);
+    if (!snapshot.is_open()) {
+        return false;
+    }
+
+    std::vector<uint32_t> mode(2, 0);
+    if (!snapshot.read("mode", mode) ||
+        (mode[0] != static_cast<uint32_t>(cfg_.m_mode)) ||
+        (mode[1] != static_cast<uint32_t>(cfg_.digital_only))) {
+        std::cerr << "Snapshot does not match the crossbar config."
+                  << std::endl;
+        return false;
+    }
+    // The planes can have the same size for different weight segments
+    const std::vector<uint32_t> expected = geometry();
+    std::vector<uint32_t> saved(expected.size(), 0);
+    if (!snapshot.read("geometry", saved) || (saved != expected)) {
+        std::cerr << "Snapshot does not match the crossbar geometry (M, N, "
+                     "SPLIT, W_BIT, I_BIT)."
+                  << std::endl;
+        return false;
+    }
+    if (rd_model_ && !snapshot.has("cycles_p")) {
+        std::cerr << "Snapshot does not contain a read disturb state."
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<uint64_t> counters(5, 0);
+    if (!snapshot.read("counters", counters) || !mapper_->load(snapshot) ||
+        (rd_model_ && !rd_model_->load(snapshot))) {
+        return false;
+    }
+    std::fill(dirty_end_.begin(), dirty_end_.end(), 0);
+    dirty_ = false;
+    placed_.clear();
+    write_xbar_counter_ = counters[0];
+    mvm_counter_ = counters[1];
+    consecutive_mvm_counter_ = counters[2];
+    refresh_xbar_counter_ = counters[3];
+    refresh_cell_counter_ = counters[4];
+    return true;
+}
+
+const ADCSchedule *Crossbar::get_adc_schedule() const {
+    return adc_schedule_.get();
+}
+
+void Crossbar::reset_adc_schedule() {
+    if (adc_schedule_) {
+        adc_schedule_->reset();
+    }
+}
+
+long Crossbar::get_weight_users() const { return mapper_->get_weight_users(); }
+
+void Crossbar::reset_adc_telemetry() {
+    ADCTelemetry *telemetry = mapper_->get_adc_telemetry();
+    if (telemetry) {
+        telemetry->reset();
+    }
+}
+
 } // namespace nq
\ No newline at end of file
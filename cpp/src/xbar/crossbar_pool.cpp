@@ -0,0 +1,215 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include "xbar/crossbar_pool.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace nq {
+
+CrossbarPool::CrossbarPool(uint32_t num_threads) :
+    next_ticket_(0), stop_(false) {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (uint32_t id = 0; id < num_threads; ++id) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t id = 0; id < num_threads; ++id) {
+        workers_[id]->thread =
+            std::thread(&CrossbarPool::worker_loop, this, id);
+    }
+}
+
+CrossbarPool::~CrossbarPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    for (auto &worker : workers_) {
+        worker->cv.notify_all();
+    }
+    for (auto &worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+CrossbarPool::Slot *CrossbarPool::get_slot(int32_t handle) {
+    if ((handle < 0) || (handle >= static_cast<int32_t>(slots_.size())) ||
+        (slots_[handle] == nullptr)) {
+        std::cerr << "Error: Invalid crossbar handle " << handle << "."
+                  << std::endl;
+        return nullptr;
+    }
+    return slots_[handle].get();
+}
+
+int32_t CrossbarPool::add_xbar(const int32_t *mat, int32_t m_matrix,
+                               int32_t n_matrix) {
+    if ((mat == nullptr) || (m_matrix <= 0) || (n_matrix <= 0)) {
+        std::cerr << "Error: Invalid matrix." << std::endl;
+        return -1;
+    }
+    if (m_matrix > CFG.M || n_matrix > CFG.N) {
+        std::cerr << "Error: Matrix dimensions exceed the crossbar size."
+                  << std::endl;
+        return -1;
+    }
+
+    auto slot = std::make_unique<Slot>();
+    slot->cfg = CFG.clone();
+    slot->mat = std::make_shared<const std::vector<int32_t>>(
+        mat, mat + static_cast<size_t>(m_matrix) * n_matrix);
+    slot->m_matrix = m_matrix;
+    slot->n_matrix = n_matrix;
+    slot->pending = 0;
+    slot->xbar = std::make_unique<Crossbar>(*slot->cfg);
+    slot->xbar->write(slot->mat->data(), m_matrix, n_matrix);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int32_t handle = slots_.size();
+    slot->worker = handle % workers_.size();
+    slots_.push_back(std::move(slot));
+    return handle;
+}
+
+int32_t CrossbarPool::replicate_xbar(int32_t handle) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot *src = get_slot(handle);
+    if (src == nullptr) {
+        return -1;
+    }
+    // Replicate after the submitted MVMs. The source is pinned like by a
+    // pending MVM, so remove_xbar waits until the replica is created.
+    done_cv_.wait(lock, [src] { return src->pending == 0; });
+    src->pending++;
+    lock.unlock();
+
+    // Without the lock: the other crossbars keep running, MVMs submitted to
+    // the source meanwhile only read the shared weights
+    auto slot = std::make_unique<Slot>();
+    slot->cfg = src->cfg;
+    slot->xbar = src->xbar->replicate();
+    slot->mat = src->mat;
+    slot->m_matrix = src->m_matrix;
+    slot->n_matrix = src->n_matrix;
+    slot->pending = 0;
+
+    lock.lock();
+    src->pending--;
+    const int32_t replica = slots_.size();
+    slot->worker = replica % workers_.size();
+    slots_.push_back(std::move(slot));
+    lock.unlock();
+    done_cv_.notify_all();
+    return replica;
+}
+
+long CrossbarPool::get_weight_users(int32_t handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot *slot = get_slot(handle);
+    if (slot == nullptr) {
+        return -1;
+    }
+    return slot->xbar->get_weight_users();
+}
+
+bool CrossbarPool::remove_xbar(int32_t handle) {
+    std::unique_ptr<Slot> slot;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Slot *s = get_slot(handle);
+        if (s == nullptr) {
+            return false;
+        }
+        done_cv_.wait(lock, [s] { return s->pending == 0; });
+        slot = std::move(slots_[handle]);
+    }
+    return true;
+}
+
+int64_t CrossbarPool::submit_mvm(int32_t handle, int32_t *res,
+                                 const int32_t *vec, int32_t m_matrix,
+                                 int32_t n_matrix) {
+    if ((res == nullptr) || (vec == nullptr)) {
+        std::cerr << "Error: res or vec is nullptr." << std::endl;
+        return -1;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot *slot = get_slot(handle);
+    if (slot == nullptr) {
+        return -1;
+    }
+    if ((m_matrix != slot->m_matrix) || (n_matrix != slot->n_matrix)) {
+        std::cerr << "Error: Matrix dimensions do not match the programmed "
+                     "matrix of crossbar "
+                  << handle << "." << std::endl;
+        return -1;
+    }
+
+    const int64_t ticket = next_ticket_++;
+    slot->pending++;
+    pending_tickets_.insert(ticket);
+    Worker &worker = *workers_[slot->worker];
+    worker.jobs.push_back(
+        {ticket, slot, res, std::vector<int32_t>(vec, vec + n_matrix)});
+    lock.unlock();
+    worker.cv.notify_one();
+    return ticket;
+}
+
+bool CrossbarPool::wait(int64_t ticket) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if ((ticket < 0) || (ticket >= next_ticket_)) {
+        std::cerr << "Error: Unknown MVM ticket " << ticket << "."
+                  << std::endl;
+        return false;
+    }
+    done_cv_.wait(lock,
+                  [this, ticket] { return !pending_tickets_.count(ticket); });
+    return true;
+}
+
+bool CrossbarPool::is_done(int64_t ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (ticket >= 0) && (ticket < next_ticket_) &&
+           !pending_tickets_.count(ticket);
+}
+
+void CrossbarPool::worker_loop(uint32_t id) {
+    Worker &worker = *workers_[id];
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Queued MVMs are finished before the pool stops
+            worker.cv.wait(lock, [this, &worker] {
+                return stop_ || !worker.jobs.empty();
+            });
+            if (worker.jobs.empty()) {
+                return;
+            }
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+        }
+
+        Slot &slot = *job.slot;
+        slot.xbar->mvm(job.res, job.vec.data(), slot.mat->data(),
+                       slot.m_matrix, slot.n_matrix);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot.pending--;
+            pending_tickets_.erase(job.ticket);
+        }
+        done_cv_.notify_all();
+    }
+}
+
+} // namespace nq
@@ -10,34 +10,35 @@
 
 namespace nq {
 
-ReadDisturb::ReadDisturb(const float V_read) :
-    cycles_p_(CFG.M * CFG.SPLIT.size(), std::vector<uint64_t>(CFG.N, 0)),
-    cycles_m_(CFG.M * CFG.SPLIT.size(), std::vector<uint64_t>(CFG.N, 0)),
-    consecutive_reads_p_(CFG.M * CFG.SPLIT.size(),
-                         std::vector<uint64_t>(CFG.N, 0)),
-    consecutive_reads_m_(CFG.M * CFG.SPLIT.size(),
-                         std::vector<uint64_t>(CFG.N, 0)),
+ReadDisturb::ReadDisturb(const Config &cfg, const float V_read) :
+    cfg_(cfg), storage_(StorageArena::create_from_config(cfg)),
+    cycles_p_(make_plane<uint64_t>(cfg_.M * cfg_.SPLIT.size(), cfg_.N, 0,
+                                   storage_.get())),
+    cycles_m_(make_plane<uint64_t>(cfg_.M * cfg_.SPLIT.size(), cfg_.N, 0,
+                                   storage_.get())),
+    consecutive_reads_p_(make_plane<uint64_t>(
+        cfg_.M * cfg_.SPLIT.size(), cfg_.N, 0, storage_.get())),
+    consecutive_reads_m_(make_plane<uint64_t>(
+        cfg_.M * cfg_.SPLIT.size(), cfg_.N, 0, storage_.get())),
     t0_(1.55e-8), fitting_param_(1.43339), c1_(0.0068), a_(0.11),
     kb_(1.38064852e-23), T_(300.0), k_(0.003), m_(0.41),
     kb_T_(kb_ * T_ / 1.602176634e-19), V_read_(V_read),
     exp_tt_(calc_exp_tt(V_read)), p_(calc_p(V_read)),
     run_out_of_bounds_(false) {}
 
-const std::vector<std::vector<uint64_t>> &ReadDisturb::get_cycles_p() const {
+const Plane<uint64_t> &ReadDisturb::get_cycles_p() const {
     return cycles_p_;
 }
 
-const std::vector<std::vector<uint64_t>> &ReadDisturb::get_cycles_m() const {
+const Plane<uint64_t> &ReadDisturb::get_cycles_m() const {
     return cycles_m_;
 }
 
-const std::vector<std::vector<uint64_t>> &
-ReadDisturb::get_consecutive_reads_p() const {
+const Plane<uint64_t> &ReadDisturb::get_consecutive_reads_p() const {
     return consecutive_reads_p_;
 }
 
-const std::vector<std::vector<uint64_t>> &
-ReadDisturb::get_consecutive_reads_m() const {
+const Plane<uint64_t> &ReadDisturb::get_consecutive_reads_m() const {
     return consecutive_reads_m_;
 }
 
@@ -56,7 +57,7 @@ void ReadDisturb::update_cycles(
 float ReadDisturb::calc_G0_scaling_factor(const uint64_t read_num,
                                           const uint64_t N_cycles) const {
     float tt = calc_transition_time(N_cycles);
-    float t_stress = read_num * CFG.t_read;
+    float t_stress = read_num * cfg_.t_read;
     if (t_stress < tt) {
         return 1.0f;
     } else {
@@ -99,9 +100,10 @@ void ReadDisturb::update_cycle_m(int m, int n, uint64_t cycles) {
     cycles_m_[m][n] += cycles;
 }
 
-void ReadDisturb::update_consecutive_reads(int32_t m_matrix, int32_t n_matrix) {
-    for (size_t m = 0; m < m_matrix; ++m) {
-        for (size_t n = 0; n < n_matrix; ++n) {
+void ReadDisturb::update_consecutive_reads(int32_t row_off, int32_t col_off,
+                                           int32_t m_matrix, int32_t n_matrix) {
+    for (size_t m = row_off; m < row_off + m_matrix; ++m) {
+        for (size_t n = col_off; n < col_off + n_matrix; ++n) {
             consecutive_reads_p_[m][n]++;
             consecutive_reads_m_[m][n]++;
         }
@@ -109,8 +111,8 @@ void ReadDisturb::update_consecutive_reads(int32_t m_matrix, int32_t n_matrix) {
 }
 
 void ReadDisturb::reset_all_consecutive_reads() {
-    for (size_t m = 0; m < CFG.M * CFG.SPLIT.size(); ++m) {
-        for (size_t n = 0; n < CFG.N; ++n) {
+    for (size_t m = 0; m < cfg_.M * cfg_.SPLIT.size(); ++m) {
+        for (size_t n = 0; n < cfg_.N; ++n) {
             consecutive_reads_p_[m][n] = 0;
             consecutive_reads_m_[m][n] = 0;
         }
@@ -129,4 +131,26 @@ const bool ReadDisturb::get_run_out_of_bounds() const {
     return run_out_of_bounds_;
 }
 
-} // namespace nq
\ No newline at end of file
+void ReadDisturb::save(SnapshotWriter &snapshot) const {
+    snapshot.add("cycles_p", cycles_p_);
+    snapshot.add("cycles_m", cycles_m_);
+    snapshot.add("consecutive_reads_p", consecutive_reads_p_);
+    snapshot.add("consecutive_reads_m", consecutive_reads_m_);
+    snapshot.add("rd_out_of_bounds",
+                 std::vector<uint32_t>{run_out_of_bounds_ ? 1u : 0u});
+}
+
+bool ReadDisturb::load(const SnapshotReader &snapshot) {
+    std::vector<uint32_t> out_of_bounds(1, 0);
+    if (!(snapshot.read("cycles_p", cycles_p_) &&
+          snapshot.read("cycles_m", cycles_m_) &&
+          snapshot.read("consecutive_reads_p", consecutive_reads_p_) &&
+          snapshot.read("consecutive_reads_m", consecutive_reads_m_) &&
+          snapshot.read("rd_out_of_bounds", out_of_bounds))) {
+        return false;
+    }
+    run_out_of_bounds_ = out_of_bounds[0] != 0;
+    return true;
+}
+
+} // namespace nq
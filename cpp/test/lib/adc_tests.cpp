@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
 
 #include "inc/test_helper.h"
 
@@ -43,6 +45,126 @@ TEST(ADCTests, PosADCTest) {
     ASSERT_THAT(res, ::testing::ElementsAre(635, -637, -1));
 }
 
+TEST(ADCTests, Telemetry) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 5;
+    int32_t mat[m_matrix * n_matrix] = {-128, -128, -128, -128, -128,
+                                        127,  127,  127,  127,  127,
+                                        -12,  88,   65,   0,    -99};
+    int32_t vec[n_matrix] = {-1, -1, -1, -1, -1};
+    int32_t res[m_matrix] = {0, 0, 0};
+
+    std::string cfg = get_cfg_file("analog/SYM_ADC_1.json");
+    set_config(cfg.c_str());
+    update_config("{\"adc_telemetry\": true}");
+
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res, ::testing::ElementsAre(643, -637, -40));
+
+    // Every conversion is counted once in the histogram
+    size_t size = 0;
+    const uint64_t *hist = get_adc_hist(&size);
+    ASSERT_NE(hist, nullptr);
+    uint64_t num_hist = 0;
+    for (size_t i = 0; i < size; ++i) {
+        num_hist += hist[i];
+    }
+    const uint64_t num = get_adc_num_conversions();
+    ASSERT_GT(num, 0);
+    ASSERT_EQ(num_hist, num);
+    ASSERT_EQ(get_adc_clip_low(), 0);
+    ASSERT_EQ(get_adc_clip_high(), 0);
+    ASSERT_LE(get_adc_min_current(), get_adc_max_current());
+
+    reset_adc_telemetry();
+    ASSERT_EQ(get_adc_num_conversions(), 0);
+
+    // A smaller clipping factor saturates the ADC
+    update_config("{\"alpha\": 0.1}");
+    status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_EQ(get_adc_num_conversions(), num);
+    ASSERT_GT(get_adc_clip_low() + get_adc_clip_high(), 0);
+}
+
+TEST(ADCTests, Schedule) {
+    const int32_t m_matrix = 4;
+    const int32_t n_matrix = 4;
+    int32_t mat[m_matrix * n_matrix] = {1, -1, 0,  1, 0, 1, 1,  -1,
+                                        1, 1,  -1, 0, 1, 0, -1, -1};
+    int32_t vec[n_matrix] = {1, -1, 1, 0};
+    int32_t res[m_matrix] = {0, 0, 0, 0};
+    const std::string cfg = get_cfg_file("analog/TNN_I.json");
+
+    // Two lines per ADC, TNN_I converts each line once per MVM
+    set_config(cfg.c_str());
+    update_config("{\"M\": 4, \"N\": 4, \"adc_share\": 2, "
+                  "\"adc_latency\": 5.0}");
+    ASSERT_EQ(cpy_mtrx(mat, m_matrix, n_matrix), 0);
+    ASSERT_EQ(exe_mvm(res, vec, mat, m_matrix, n_matrix), 0);
+    ASSERT_THAT(res, ::testing::ElementsAre(2, 0, -1, 0));
+    ASSERT_EQ(get_adc_num_adcs(), 2);
+    ASSERT_EQ(get_adc_cycles(), 2);
+    ASSERT_FLOAT_EQ(get_adc_latency(), 10.0);
+
+    // Gated rows 0 and 2 are converted by different ADCs in parallel
+    const int32_t rows[2] = {0, 2};
+    ASSERT_EQ(exe_mvm_rows(res, vec, mat, m_matrix, n_matrix, rows, 2), 0);
+    ASSERT_EQ(get_adc_cycles(), 1);
+    const int32_t runs[3] = {0, 1, 3};
+    ASSERT_EQ(exe_mvm_rows(res, vec, mat, m_matrix, n_matrix, runs, 3), 0);
+    ASSERT_EQ(get_adc_cycles(), 2);
+    ASSERT_EQ(exe_mvm_region(res, vec, 1, 0, 2, n_matrix), 0);
+    ASSERT_EQ(get_adc_cycles(), 1);
+    ASSERT_EQ(get_adc_total_cycles(), 6);
+    ASSERT_EQ(get_adc_scheduled_mvms(), 4);
+    reset_adc_schedule();
+    ASSERT_EQ(get_adc_total_cycles(), 0);
+
+    // Interleaved: rows 0 and 2 share ADC 0
+    update_config("{\"adc_mux_order\": \"INTERLEAVED\"}");
+    ASSERT_EQ(exe_mvm_rows(res, vec, mat, m_matrix, n_matrix, rows, 2), 0);
+    ASSERT_EQ(get_adc_cycles(), 2);
+    ASSERT_EQ(exe_mvm_region(res, vec, 1, 0, 2, n_matrix), 0);
+    ASSERT_EQ(get_adc_cycles(), 1);
+
+    // Bit-serial INT MVM: one round per input bit, one line per segment
+    int32_t mat_int[m_matrix * n_matrix];
+    int32_t vec_int[n_matrix] = {5, -3, 100, 0};
+    for (int32_t i = 0; i < m_matrix * n_matrix; ++i) {
+        mat_int[i] = mat[i] * 37;
+    }
+    std::vector<int32_t> res_ref(m_matrix, 0);
+    set_config(get_cfg_file("analog/I_DIFF_W_DIFF_1XB.json").c_str());
+    update_config("{\"M\": 4, \"N\": 4}");
+    ASSERT_EQ(cpy_mtrx(mat_int, m_matrix, n_matrix), 0);
+    ASSERT_EQ(exe_mvm(res_ref.data(), vec_int, mat_int, m_matrix, n_matrix), 0);
+
+    uint64_t rounds = 0;
+    for (int32_t share : {1, 3, 12}) {
+        set_config(get_cfg_file("analog/I_DIFF_W_DIFF_1XB.json").c_str());
+        update_config(("{\"M\": 4, \"N\": 4, \"adc_share\": " +
+                       std::to_string(share) + "}")
+                          .c_str());
+        ASSERT_EQ(cpy_mtrx(mat_int, m_matrix, n_matrix), 0);
+        std::vector<int32_t> res_int(m_matrix, 0);
+        ASSERT_EQ(
+            exe_mvm(res_int.data(), vec_int, mat_int, m_matrix, n_matrix), 0);
+        ASSERT_EQ(res_int, res_ref) << share;
+        ASSERT_EQ(get_adc_num_adcs(), 12 / share);
+        if (share == 1) {
+            rounds = get_adc_cycles();
+            ASSERT_GT(rounds, 0);
+        }
+        ASSERT_EQ(get_adc_cycles(), rounds * share);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -15,24 +15,88 @@
 #include <iostream>
 #include <string>
 
+#include "helper/storage.h"
+
 // C interface of acs_int
 extern "C" {
 int32_t exe_mvm(int32_t *res, int32_t *vec, int32_t *mat, int32_t m_matrix,
-                int32_t n_matrix);
+                int32_t n_matrix, const char *l_name = "Unknown");
+int32_t exe_mvm_rows(int32_t *res, int32_t *vec, int32_t *mat, int32_t m_matrix,
+                     int32_t n_matrix, const int32_t *rows, int32_t num_rows);
 int32_t cpy_mtrx(int32_t *mat, int32_t m_matrix, int32_t n_matrix,
                  const char *l_name = "Unkown");
+int32_t write_region(int32_t *mat, int32_t row_off, int32_t col_off,
+                     int32_t m_matrix, int32_t n_matrix);
+int32_t place_mtrx(int32_t *mat, int32_t m_matrix, int32_t n_matrix,
+                   int32_t *row_off, int32_t *col_off);
+int32_t exe_mvm_region(int32_t *res, int32_t *vec, int32_t row_off,
+                       int32_t col_off, int32_t m_matrix, int32_t n_matrix);
 void set_config(const char *cfg_file);
+void update_config(const char *json_config);
+int32_t save_config(const char *cfg_file);
+const uint64_t get_config_fingerprint();
 const void *get_ia_p(size_t *size);
 const void *get_ia_m(size_t *size);
 const void *get_gd_p(size_t *size);
 const void *get_gd_m(size_t *size);
+const uint64_t *get_adc_hist(size_t *size);
+const uint64_t get_adc_clip_low();
+const uint64_t get_adc_clip_high();
+const uint64_t get_adc_num_conversions();
+const float get_adc_min_current();
+const float get_adc_max_current();
+void reset_adc_telemetry();
+const uint64_t get_adc_cycles();
+const float get_adc_latency();
+const uint64_t get_adc_total_cycles();
+const uint64_t get_adc_scheduled_mvms();
+const uint32_t get_adc_num_adcs();
+void reset_adc_schedule();
+int32_t save_xbar(const char *path);
+int32_t load_xbar(const char *path);
+int32_t start_trace(const char *path);
+void stop_trace();
+int32_t run_sweep(const char *deltas, const char *trace_path,
+                  const char *csv_path, uint32_t num_threads);
+const uint64_t get_sweep_num_programmed();
+int32_t net_create();
+int32_t net_add_dense(int32_t net, const int32_t *weights, int32_t out_features,
+                      int32_t in_features, const int32_t *bias,
+                      const float *scale, int32_t num_scales, int32_t out_min,
+                      int32_t out_max, const char *l_name = "Unknown");
+int32_t net_add_conv2d(int32_t net, const int32_t *weights, int32_t in_channels,
+                       int32_t in_h, int32_t in_w, int32_t out_channels,
+                       int32_t kernel_h, int32_t kernel_w, int32_t stride,
+                       int32_t padding, int32_t dilation, int32_t groups,
+                       const int32_t *bias, const float *scale,
+                       int32_t num_scales, int32_t out_min, int32_t out_max,
+                       const char *l_name = "Unknown");
+int32_t net_set_threads(int32_t net, uint32_t num_threads);
+int32_t net_run(int32_t net, const int32_t *inputs, int32_t batch,
+                float *logits);
+int32_t net_run_pipelined(int32_t net, const int32_t *inputs, int32_t batch,
+                          float *logits, uint32_t queue_depth);
+int32_t net_num_layers(int32_t net);
+int32_t net_stage_occupancy(int32_t net, double *occupancy);
+void net_destroy(int32_t net);
+int32_t xbar_create(const int32_t *mat, int32_t m_matrix, int32_t n_matrix);
+int32_t xbar_replicate(int32_t handle);
+int64_t xbar_weight_users(int32_t handle);
+int64_t submit_mvm(int32_t handle, int32_t *res, const int32_t *vec,
+                   int32_t m_matrix, int32_t n_matrix);
+int32_t wait_mvm(int64_t ticket);
+bool mvm_done(int64_t ticket);
+int32_t xbar_destroy(int32_t handle);
 }
 
 // C++ interface of acs_int
-extern const std::vector<std::vector<float>> &get_ia_p();
-extern const std::vector<std::vector<float>> &get_ia_m();
-extern const std::vector<std::vector<int32_t>> &get_gd_p();
-extern const std::vector<std::vector<int32_t>> &get_gd_m();
+extern const nq::Plane<float> &get_ia_p();
+extern const nq::Plane<float> &get_ia_m();
+extern const nq::Plane<int32_t> &get_gd_p();
+extern const nq::Plane<int32_t> &get_gd_m();
+extern const nq::Plane<uint64_t> &get_cycles_p();
+extern const nq::Plane<uint64_t> &get_cycles_m();
+extern const nq::Plane<uint64_t> &get_consecutive_reads_p();
 
 std::string get_cfg_file(const std::string &file_name) {
     const char *cfg_dir = std::getenv("CFG_DIR_TESTS");
@@ -5,12 +5,15 @@
  * This is work is licensed under the terms described in the LICENSE file     *
  * found in the root directory of this source tree.                           *
  ******************************************************************************/
+#include <algorithm>
 #include <cstdlib>
 #include <dlfcn.h>
 #include <filesystem>
+#include <fstream>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <string>
+#include <vector>
 
 #include "inc/test_helper.h"
 
@@ -176,6 +179,213 @@ TEST(INTLibTests, I_UINT_W_OFFS) {
     }
 }
 
+TEST(INTLibTests, SPLIT_kernels) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 2;
+    int32_t vec_int[n_matrix] = {-120, 55};
+    int32_t vec_uint[n_matrix] = {120, 55};
+    int32_t mat[m_matrix * n_matrix] = {100, -32, 1, 0, 12, 1};
+
+    // Specialized kernels (1, 2, 4 and 8 segments) and generic kernel
+    const std::string splits[] = {"[1, 1, 1, 1, 1, 1, 1, 1]", "[2, 2, 2, 2]",
+                                  "[4, 4]", "[8]", "[3, 5]"};
+    const std::string modes[] = {"I_DIFF_W_DIFF_1XB", "I_OFFS_W_DIFF",
+                                 "I_TC_W_DIFF",       "I_UINT_W_DIFF",
+                                 "I_UINT_W_OFFS"};
+
+    for (bool d : digital) {
+        for (const std::string &mode : modes) {
+            bool uint_input = mode.rfind("I_UINT", 0) == 0;
+            int32_t *vec = uint_input ? vec_uint : vec_int;
+            for (const std::string &split : splits) {
+                set_config(
+                    get_cfg_file(digital_to_foldername(d) + mode + ".json")
+                        .c_str());
+                update_config(("{\"SPLIT\": " + split + "}").c_str());
+                int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+                ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+
+                int32_t res[m_matrix] = {0, 0, 0};
+                status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+                ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+                if (uint_input) {
+                    ASSERT_THAT(res, ::testing::ElementsAre(10240, 120, 1495))
+                        << mode << " " << split;
+                } else {
+                    ASSERT_THAT(res,
+                                ::testing::ElementsAre(-13760, -120, -1385))
+                        << mode << " " << split;
+                }
+            }
+        }
+    }
+}
+
+TEST(INTLibTests, DIGITAL_SHORTCUT) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 2;
+    int32_t vec[n_matrix] = {-120, 55};
+    int32_t mat[m_matrix * n_matrix] = {100, -32, 1, 0, 12, 1};
+
+    // Ideal analog configs are computed with the digital MVM
+    const std::string modes[] = {"I_DIFF_W_DIFF_1XB", "I_OFFS_W_DIFF",
+                                 "I_TC_W_DIFF", "BNN_I", "TNN_I"};
+    for (const std::string &mode : modes) {
+        for (bool shortcut : {true, false}) {
+            set_config(
+                get_cfg_file(digital_to_foldername(false) + mode + ".json")
+                    .c_str());
+            update_config(
+                ("{\"adc_type\": \"INF_ADC\", \"read_disturb\": false, "
+                 "\"digital_shortcut\": " +
+                 std::string(shortcut ? "true" : "false") + "}")
+                    .c_str());
+
+            bool is_int = mode.rfind("I_", 0) == 0;
+            int32_t bin_vec[n_matrix] = {-1, 1};
+            int32_t bin_mat[m_matrix * n_matrix] = {1, -1, -1, -1, 1, 1};
+            int32_t *v = is_int ? vec : bin_vec;
+            int32_t *w = is_int ? mat : bin_mat;
+
+            int32_t status = cpy_mtrx(w, m_matrix, n_matrix);
+            ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+
+            int32_t res[m_matrix] = {0, 0, 0};
+            status = exe_mvm(res, v, w, m_matrix, n_matrix);
+            ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+            if (is_int) {
+                ASSERT_THAT(res, ::testing::ElementsAre(-13760, -120, -1385))
+                    << mode;
+            } else {
+                ASSERT_THAT(res, ::testing::ElementsAre(-2, 0, 0)) << mode;
+            }
+        }
+    }
+}
+
+TEST(INTLibTests, DIGITAL_REFERENCE) {
+    // Matrix size is not a multiple of the packed row length
+    const int32_t m_matrix = 7;
+    const int32_t n_matrix = 29;
+    int32_t mat[m_matrix * n_matrix];
+    int32_t vec_int[n_matrix];
+    int32_t vec_uint[n_matrix];
+    for (int32_t i = 0; i < m_matrix * n_matrix; ++i) {
+        mat[i] = (i * 37 + 11) % 256 - 128;
+    }
+    for (int32_t n = 0; n < n_matrix; ++n) {
+        vec_int[n] = (n * 53 + 7) % 256 - 128;
+        vec_uint[n] = (n * 53 + 7) % 256;
+    }
+
+    const std::string modes[] = {"I_DIFF_W_DIFF_1XB", "I_OFFS_W_DIFF",
+                                 "I_TC_W_DIFF",       "I_UINT_W_DIFF",
+                                 "I_UINT_W_OFFS"};
+    for (const std::string &mode : modes) {
+        bool uint_input = mode.rfind("I_UINT", 0) == 0;
+        int32_t *vec = uint_input ? vec_uint : vec_int;
+        set_config(
+            get_cfg_file(digital_to_foldername(true) + mode + ".json").c_str());
+        int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+
+        int32_t res[m_matrix] = {0};
+        status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+        for (int32_t m = 0; m < m_matrix; ++m) {
+            int32_t ref = 0;
+            for (int32_t n = 0; n < n_matrix; ++n) {
+                ref += mat[m * n_matrix + n] * vec[n];
+            }
+            ASSERT_EQ(res[m], ref) << mode << " row " << m;
+        }
+    }
+}
+
+TEST(INTLibTests, SPARSE_WEIGHTS) {
+    // 3 out of 20 weights per row are nonzero
+    const int32_t m_matrix = 4;
+    const int32_t n_matrix = 20;
+    int32_t mat[m_matrix * n_matrix] = {0};
+    int32_t vec[n_matrix];
+    for (int32_t m = 0; m < m_matrix; ++m) {
+        mat[m * n_matrix + m] = 1;
+        mat[m * n_matrix + 2 * m + 5] = -1;
+        mat[m * n_matrix + 19 - m] = (m % 2) ? 1 : -1;
+    }
+    for (int32_t n = 0; n < n_matrix; ++n) {
+        vec[n] = (n % 3) - 1;
+    }
+
+    const std::string modes[] = {"TNN_I",         "TNN_II",
+                                 "TNN_III",       "TNN_IV_split",
+                                 "TNN_V_split",   "I_DIFF_W_DIFF_1XB",
+                                 "I_OFFS_W_DIFF", "I_TC_W_DIFF"};
+    for (bool d : digital) {
+        for (const std::string &mode : modes) {
+            for (const char *threshold : {"0.0", "0.5"}) {
+                set_config(
+                    get_cfg_file(digital_to_foldername(d) + mode + ".json")
+                        .c_str());
+                update_config((std::string("{\"sparse_threshold\": ") +
+                               threshold + "}")
+                                  .c_str());
+                int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+                ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+
+                int32_t res[m_matrix] = {0};
+                status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+                ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+                for (int32_t m = 0; m < m_matrix; ++m) {
+                    int32_t ref = 0;
+                    for (int32_t n = 0; n < n_matrix; ++n) {
+                        ref += mat[m * n_matrix + n] * vec[n];
+                    }
+                    ASSERT_EQ(res[m], ref)
+                        << mode << " threshold " << threshold << " row " << m;
+                }
+            }
+        }
+    }
+}
+
+TEST(INTLibTests, INPUT_SPARSITY) {
+    // Most inputs are zero and the upper bit planes are empty
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 16;
+    int32_t mat[m_matrix * n_matrix];
+    int32_t vec[n_matrix] = {0, 3, 0, 0, 0, 0, 12, 0, 0, 0, 0, 0, 0, 5, 0, 0};
+    for (int32_t i = 0; i < m_matrix * n_matrix; ++i) {
+        mat[i] = (i * 29 + 3) % 255 - 127;
+    }
+
+    const std::string modes[] = {"I_DIFF_W_DIFF_1XB", "I_OFFS_W_DIFF",
+                                 "I_TC_W_DIFF",       "I_UINT_W_DIFF",
+                                 "I_UINT_W_OFFS"};
+    for (const std::string &mode : modes) {
+        set_config(get_cfg_file(digital_to_foldername(false) + mode + ".json")
+                       .c_str());
+        int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+
+        int32_t zero_vec[n_matrix] = {0};
+        int32_t res[m_matrix] = {0};
+        status = exe_mvm(res, zero_vec, mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+        ASSERT_THAT(res, ::testing::ElementsAre(0, 0, 0)) << mode;
+
+        status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+        for (int32_t m = 0; m < m_matrix; ++m) {
+            int32_t ref = 0;
+            for (int32_t n = 0; n < n_matrix; ++n) {
+                ref += mat[m * n_matrix + n] * vec[n];
+            }
+            ASSERT_EQ(res[m], ref) << mode << " row " << m;
+        }
+    }
+}
+
 TEST(INTLibTests, BNN_I) {
     const int32_t m_matrix = 3;
     const int32_t n_matrix = 2;
@@ -459,6 +669,271 @@ TEST(INTLibTests, TNN_V_split) {
     }
 }
 
+TEST(INTLibTests, TRACE) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 3;
+    int32_t vec[n_matrix] = {1, -1, 0};
+    int32_t mat[m_matrix * n_matrix] = {1, 1, 1, -1, -1, -1, 0, -1, 1};
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "acs_trace_test.bin")
+            .string();
+
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    ASSERT_EQ(start_trace(path.c_str()), 0) << "Starting the trace failed.";
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix, "fc1");
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    int32_t res[m_matrix] = {1, -1, 1};
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix, "fc1");
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res, ::testing::ElementsAre(1, -1, 2));
+    stop_trace();
+
+    // Not recorded
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix, "fc1");
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+
+    // Header (12 bytes), CPY record (14 + 1 + 9 bytes), MVM record
+    // (14 + 3 * (1 + 3) bytes): all operands fit into one byte per element
+    ASSERT_EQ(std::filesystem::file_size(path), 12 + 24 + 26);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(start_trace("/nonexistent/acs_trace_test.bin"), -1);
+}
+
+TEST(INTLibTests, SWEEP) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 3;
+    int32_t vec1[n_matrix] = {1, -1, 0};
+    int32_t vec2[n_matrix] = {1, 0, 1};
+    int32_t mat[m_matrix * n_matrix] = {1, 1, 1, -1, -1, -1, 0, -1, 1};
+    const std::filesystem::path tmp_dir =
+        std::filesystem::temp_directory_path();
+    const std::string trace = (tmp_dir / "acs_sweep_test.bin").string();
+    const std::string csv = (tmp_dir / "acs_sweep_test.csv").string();
+
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    ASSERT_EQ(start_trace(trace.c_str()), 0) << "Starting the trace failed.";
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix, "fc1");
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    for (int32_t i = 0; i < 4; ++i) {
+        int32_t res[m_matrix] = {0, 0, 0};
+        status = exe_mvm(res, (i % 2) ? vec2 : vec1, mat, m_matrix, n_matrix,
+                         "fc1");
+        ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    }
+    stop_trace();
+
+    // Points: base config, noisy cells, crossbar too small for the workload
+    const char *deltas = "[{}, {\"HRS_NOISE\": 2.0, \"LRS_NOISE\": 2.0}, "
+                         "{\"M\": 2}, {\"resolution\": 16}]";
+    ASSERT_EQ(run_sweep(deltas, trace.c_str(), csv.c_str(), 2), 0);
+
+    std::ifstream file(csv);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 5);
+    ASSERT_EQ(lines[0], "point,delta,valid,cpy_ops,mvm_ops,mismatches,"
+                        "mean_abs_err,max_abs_err,time_s");
+    ASSERT_EQ(lines[1].rfind("0,\"{}\",1,1,4,0,0,0,", 0), 0) << lines[1];
+    ASSERT_EQ(lines[3].rfind("2,\"{\"\"M\"\":2}\",0,0,0,0,0,0,", 0), 0)
+        << lines[3];
+    ASSERT_EQ(lines[4].rfind("3,\"{\"\"resolution\"\":16}\",1,1,4,0,0,0,", 0),
+              0)
+        << lines[4];
+    // The matrix is programmed once for the valid points of one geometry
+    ASSERT_EQ(get_sweep_num_programmed(), 1);
+
+    // One programmed crossbar per geometry (N), all points are exact
+    const char *geometries = "[{\"N\": 4}, {\"resolution\": 16}, "
+                             "{\"N\": 4, \"resolution\": 16}]";
+    ASSERT_EQ(run_sweep(geometries, trace.c_str(), csv.c_str(), 1), 0);
+    ASSERT_EQ(get_sweep_num_programmed(), 2);
+    std::ifstream geometry_file(csv);
+    lines.clear();
+    for (std::string line; std::getline(geometry_file, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 4);
+    for (size_t p = 1; p < lines.size(); ++p) {
+        ASSERT_NE(lines[p].find(",1,1,4,0,0,0,"), std::string::npos)
+            << lines[p];
+    }
+
+    // The sweep does not change the global crossbar
+    int32_t res[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res, vec1, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res, ::testing::ElementsAre(0, 0, 1));
+
+    std::filesystem::remove(trace);
+    std::filesystem::remove(csv);
+}
+
+TEST(INTLibTests, ASYNC_MVM) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    const int32_t num_mvms = 20;
+    const int32_t mats[2][m_matrix * n_matrix] = {
+        {1, -1, 0, 1, 0, 1, 1, -1, -1, 0, 1, 1},
+        {0, 1, -1, -1, 1, 1, 0, 0, -1, 1, 1, 0}};
+    std::vector<int32_t> vecs(num_mvms * n_matrix);
+    for (size_t i = 0; i < vecs.size(); ++i) {
+        vecs[i] = static_cast<int32_t>(i * 5 % 3) - 1;
+    }
+
+    // Read disturb: the results depend on the previous MVMs of the crossbar
+    auto load_cfg = [] {
+        set_config(get_cfg_file("analog/TNN_I.json").c_str());
+        update_config(
+            "{\"read_disturb\": true, \"V_read\": -0.4, "
+            "\"t_read\": 100e-9, "
+            "\"read_disturb_mitigation_strategy\": \"CELL_BASED\", "
+            "\"read_disturb_update_tolerance\": 0.05}");
+    };
+
+    // Reference: synchronous MVMs, one fresh crossbar per matrix
+    std::vector<int32_t> expected[2];
+    for (int32_t x = 0; x < 2; ++x) {
+        load_cfg();
+        int32_t mat[m_matrix * n_matrix];
+        std::copy(mats[x], mats[x] + m_matrix * n_matrix, mat);
+        ASSERT_EQ(cpy_mtrx(mat, m_matrix, n_matrix), 0);
+        expected[x].resize(num_mvms * m_matrix);
+        for (int32_t i = 0; i < num_mvms; ++i) {
+            ASSERT_EQ(exe_mvm(expected[x].data() + i * m_matrix,
+                              vecs.data() + i * n_matrix, mat, m_matrix,
+                              n_matrix),
+                      0);
+        }
+    }
+
+    // Interleaved submissions on both crossbars, wait at the end
+    load_cfg();
+    int32_t handles[2];
+    for (int32_t x = 0; x < 2; ++x) {
+        handles[x] = xbar_create(mats[x], m_matrix, n_matrix);
+        ASSERT_GE(handles[x], 0);
+    }
+    std::vector<int32_t> res[2];
+    std::vector<int64_t> tickets;
+    for (int32_t x = 0; x < 2; ++x) {
+        res[x].resize(num_mvms * m_matrix);
+    }
+    for (int32_t i = 0; i < num_mvms; ++i) {
+        for (int32_t x = 0; x < 2; ++x) {
+            tickets.push_back(submit_mvm(
+                handles[x], res[x].data() + i * m_matrix,
+                vecs.data() + i * n_matrix, m_matrix, n_matrix));
+            ASSERT_GE(tickets.back(), 0);
+        }
+    }
+    ASSERT_EQ(submit_mvm(handles[0], res[0].data(), vecs.data(), m_matrix,
+                         n_matrix + 1),
+              -1);
+    for (int64_t ticket : tickets) {
+        ASSERT_EQ(wait_mvm(ticket), 0);
+        ASSERT_TRUE(mvm_done(ticket));
+    }
+    ASSERT_EQ(wait_mvm(tickets.back() + 1), -1);
+    ASSERT_EQ(res[0], expected[0]);
+    ASSERT_EQ(res[1], expected[1]);
+
+    for (int32_t x = 0; x < 2; ++x) {
+        ASSERT_EQ(xbar_destroy(handles[x]), 0);
+    }
+    ASSERT_EQ(submit_mvm(handles[0], res[0].data(), vecs.data(), m_matrix,
+                         n_matrix),
+              -1);
+}
+
+TEST(INTLibTests, ASYNC_REPLICAS) {
+    const int32_t m_matrix = 4;
+    const int32_t n_matrix = 5;
+    const int32_t num_replicas = 4;
+    const int32_t num_mvms = 10;
+    int32_t mat[m_matrix * n_matrix];
+    for (int32_t i = 0; i < m_matrix * n_matrix; ++i) {
+        mat[i] = (i * 37 % 255) - 127;
+    }
+    std::vector<int32_t> vecs(num_mvms * n_matrix);
+    for (size_t i = 0; i < vecs.size(); ++i) {
+        vecs[i] = static_cast<int32_t>(i * 53 % 255) - 127;
+    }
+
+    // Reference: synchronous MVMs
+    set_config(get_cfg_file("analog/SYM_ADC_1.json").c_str());
+    update_config("{\"M\": 4, \"I_BIT\": 8}");
+    ASSERT_EQ(cpy_mtrx(mat, m_matrix, n_matrix), 0);
+    std::vector<int32_t> expected(num_mvms * m_matrix, 0);
+    for (int32_t i = 0; i < num_mvms; ++i) {
+        ASSERT_EQ(exe_mvm(expected.data() + i * m_matrix,
+                          vecs.data() + i * n_matrix, mat, m_matrix, n_matrix),
+                  0);
+    }
+
+    // The replicas keep the shared weights after the source is destroyed
+    const int32_t src = xbar_create(mat, m_matrix, n_matrix);
+    ASSERT_GE(src, 0);
+    std::vector<int32_t> handles;
+    for (int32_t r = 0; r < num_replicas; ++r) {
+        handles.push_back(xbar_replicate(r ? handles.back() : src));
+        ASSERT_GE(handles.back(), 0);
+    }
+    ASSERT_EQ(xbar_destroy(src), 0);
+    ASSERT_EQ(xbar_replicate(src), -1);
+
+    std::vector<std::vector<int32_t>> res(num_replicas);
+    std::vector<int64_t> tickets;
+    for (int32_t r = 0; r < num_replicas; ++r) {
+        res[r].assign(num_mvms * m_matrix, 0);
+        for (int32_t i = 0; i < num_mvms; ++i) {
+            tickets.push_back(submit_mvm(
+                handles[r], res[r].data() + i * m_matrix,
+                vecs.data() + i * n_matrix, m_matrix, n_matrix));
+            ASSERT_GE(tickets.back(), 0);
+        }
+    }
+    for (int64_t ticket : tickets) {
+        ASSERT_EQ(wait_mvm(ticket), 0);
+    }
+    for (int32_t r = 0; r < num_replicas; ++r) {
+        ASSERT_EQ(res[r], expected) << "replica " << r;
+        ASSERT_EQ(xbar_destroy(handles[r]), 0);
+    }
+}
+
+TEST(INTLibTests, REPLICA_SHARED_WEIGHTS) {
+    const int32_t m_matrix = 4;
+    const int32_t n_matrix = 5;
+    int32_t mat[m_matrix * n_matrix];
+    for (int32_t i = 0; i < m_matrix * n_matrix; ++i) {
+        mat[i] = (i * 37 % 255) - 127;
+    }
+    set_config(get_cfg_file("analog/SYM_ADC_1.json").c_str());
+    update_config("{\"M\": 4, \"I_BIT\": 8}");
+
+    // The replicas use the weight planes of the source, no own copy
+    const int32_t src = xbar_create(mat, m_matrix, n_matrix);
+    ASSERT_GE(src, 0);
+    ASSERT_EQ(xbar_weight_users(src), 1);
+    const int32_t replica_a = xbar_replicate(src);
+    const int32_t replica_b = xbar_replicate(replica_a);
+    ASSERT_GE(replica_a, 0);
+    ASSERT_GE(replica_b, 0);
+    for (int32_t handle : {src, replica_a, replica_b}) {
+        ASSERT_EQ(xbar_weight_users(handle), 3) << "handle " << handle;
+    }
+
+    ASSERT_EQ(xbar_destroy(src), 0);
+    ASSERT_EQ(xbar_weight_users(src), -1);
+    ASSERT_EQ(xbar_weight_users(replica_a), 2);
+    ASSERT_EQ(xbar_destroy(replica_a), 0);
+    ASSERT_EQ(xbar_weight_users(replica_b), 1);
+    ASSERT_EQ(xbar_destroy(replica_b), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "inc/test_helper.h"
+
+const bool digital[2] = {true, false};
+
+std::string digital_to_foldername(const bool digital) {
+    return digital ? "digital/" : "analog/";
+}
+
+// Reference of a quantized dense layer: (W * x + bias) * scale
+std::vector<double> ref_dense(const std::vector<int32_t> &w,
+                              const std::vector<int32_t> &x,
+                              const std::vector<int32_t> &bias,
+                              const std::vector<float> &scale, int32_t m,
+                              int32_t n) {
+    std::vector<double> out(m);
+    for (int32_t i = 0; i < m; ++i) {
+        int32_t acc = bias.empty() ? 0 : bias[i];
+        for (int32_t j = 0; j < n; ++j) {
+            acc += w[i * n + j] * x[j];
+        }
+        out[i] = acc * static_cast<double>(scale[(scale.size() == 1) ? 0 : i]);
+    }
+    return out;
+}
+
+TEST(NetworkTests, DenseNetwork) {
+    const int32_t batch = 2;
+    const std::vector<int32_t> w1 = {3,  -1, 0,  7, 2,  -5, 4,  1, 0,  -2,
+                                     8,  6,  -3, 1, 0,  2,  2,  2, 2,  2,
+                                     -7, 0,  5,  3, -1, 1,  -4, 6, -2, 9};
+    const std::vector<int32_t> b1 = {1, -2, 0, 5, -3, 4};
+    const std::vector<float> s1 = {0.25f};
+    const std::vector<int32_t> w2 = {1, -1, 2, 0, 3, -2, 4, 0, -1,
+                                     2, 1,  1, 0, 5, -3, 1, 2, -4};
+    const std::vector<float> s2 = {1.0f, 0.5f, 2.0f};
+    const std::vector<int32_t> inputs = {12, -7, 33, 0, -100, 5, 90, -18, 4, 2};
+
+    // Reference: ReLU after the first layer
+    std::vector<float> expected;
+    for (int32_t b = 0; b < batch; ++b) {
+        const std::vector<int32_t> x(inputs.begin() + b * 5,
+                                     inputs.begin() + (b + 1) * 5);
+        std::vector<int32_t> act;
+        for (double v : ref_dense(w1, x, b1, s1, 6, 5)) {
+            act.push_back(std::clamp<long>(std::lround(v), 0, 127));
+        }
+        for (double v : ref_dense(w2, act, {}, s2, 3, 6)) {
+            expected.push_back(v);
+        }
+    }
+
+    for (bool d : digital) {
+        std::string cfg =
+            get_cfg_file(digital_to_foldername(d) + "I_DIFF_W_DIFF_1XB.json");
+        set_config(cfg.c_str());
+        // Small crossbars: the layers are distributed to multiple tiles
+        update_config("{\"M\": 4, \"N\": 3}");
+
+        const int32_t net = net_create();
+        ASSERT_GE(net, 0);
+        ASSERT_EQ(net_add_dense(net, w1.data(), 6, 5, b1.data(), s1.data(), 1,
+                                0, 127, "fc1"),
+                  0);
+        // Input size does not match the previous layer
+        ASSERT_EQ(net_add_dense(net, w2.data(), 3, 5, nullptr, s2.data(), 3,
+                                -128, 127, "fc2"),
+                  -1);
+        ASSERT_EQ(net_add_dense(net, w2.data(), 3, 6, nullptr, s2.data(), 3,
+                                -128, 127, "fc2"),
+                  0);
+
+        std::vector<float> logits(batch * 3);
+        ASSERT_EQ(net_run(net, inputs.data(), batch, logits.data()), 0);
+        ASSERT_THAT(logits, ::testing::ElementsAreArray(expected));
+
+        // The network keeps its config
+        update_config("{\"M\": 32, \"N\": 32}");
+        std::vector<float> logits2(batch * 3);
+        ASSERT_EQ(net_run(net, inputs.data(), batch, logits2.data()), 0);
+        ASSERT_THAT(logits2, ::testing::ElementsAreArray(expected));
+
+        net_destroy(net);
+        ASSERT_EQ(net_run(net, inputs.data(), batch, logits.data()), -1);
+    }
+}
+
+// Reference of a 2D convolution (CHW layout), returns acc + bias
+std::vector<float> ref_conv2d(const std::vector<int32_t> &w,
+                              const std::vector<int32_t> &x,
+                              const std::vector<int32_t> &bias, int32_t c,
+                              int32_t h, int32_t wd, int32_t oc, int32_t k,
+                              int32_t stride, int32_t pad, int32_t dil,
+                              int32_t groups) {
+    const int32_t oh = (h + 2 * pad - dil * (k - 1) - 1) / stride + 1;
+    const int32_t ow = (wd + 2 * pad - dil * (k - 1) - 1) / stride + 1;
+    const int32_t cg = c / groups;
+    const int32_t ocg = oc / groups;
+    std::vector<float> out;
+    for (int32_t o = 0; o < oc; ++o) {
+        for (int32_t oy = 0; oy < oh; ++oy) {
+            for (int32_t ox = 0; ox < ow; ++ox) {
+                int32_t acc = bias[o];
+                for (int32_t ci = 0; ci < cg; ++ci) {
+                    const int32_t ch = (o / ocg) * cg + ci;
+                    for (int32_t ky = 0; ky < k; ++ky) {
+                        for (int32_t kx = 0; kx < k; ++kx) {
+                            const int32_t iy = oy * stride - pad + ky * dil;
+                            const int32_t ix = ox * stride - pad + kx * dil;
+                            if ((iy < 0) || (iy >= h) || (ix < 0) ||
+                                (ix >= wd)) {
+                                continue;
+                            }
+                            acc += w[((o * cg + ci) * k + ky) * k + kx] *
+                                   x[(ch * h + iy) * wd + ix];
+                        }
+                    }
+                }
+                out.push_back(acc);
+            }
+        }
+    }
+    return out;
+}
+
+TEST(NetworkTests, Conv2d) {
+    const int32_t batch = 2;
+    const int32_t c = 4;
+    const int32_t h = 5;
+    const int32_t wd = 4;
+    const float scale = 1.0f;
+    std::vector<int32_t> inputs(batch * c * h * wd);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = static_cast<int32_t>(i * 5 % 13) - 6;
+    }
+
+    // oc, kernel, stride, padding, dilation, groups
+    const std::vector<std::vector<int32_t>> convs = {
+        {3, 3, 2, 1, 1, 1}, // Strided convolution
+        {4, 3, 1, 2, 2, 4}, // Dilated depthwise convolution
+        {6, 2, 1, 0, 1, 2}, // Grouped convolution
+    };
+    // Crossbar sizes: groups share tiles / weights are split into tiles
+    const char *xbar_sizes[] = {"{\"M\": 4, \"N\": 20}",
+                                "{\"M\": 2, \"N\": 5}"};
+
+    for (bool d : digital) {
+        for (const char *xbar_size : xbar_sizes) {
+            for (const auto &conv : convs) {
+                const int32_t oc = conv[0];
+                const int32_t k = conv[1];
+                const int32_t groups = conv[5];
+                std::vector<int32_t> w(oc * (c / groups) * k * k);
+                for (size_t i = 0; i < w.size(); ++i) {
+                    w[i] = static_cast<int32_t>(i * 7 % 11) - 5;
+                }
+                std::vector<int32_t> bias(oc);
+                for (int32_t o = 0; o < oc; ++o) {
+                    bias[o] = o - 1;
+                }
+
+                std::vector<float> expected;
+                for (int32_t b = 0; b < batch; ++b) {
+                    const std::vector<int32_t> x(
+                        inputs.begin() + b * c * h * wd,
+                        inputs.begin() + (b + 1) * c * h * wd);
+                    for (float v : ref_conv2d(w, x, bias, c, h, wd, oc, k,
+                                              conv[2], conv[3], conv[4],
+                                              groups)) {
+                        expected.push_back(v);
+                    }
+                }
+
+                set_config(get_cfg_file(digital_to_foldername(d) +
+                                        "I_DIFF_W_DIFF_1XB.json")
+                               .c_str());
+                update_config(xbar_size);
+                const int32_t net = net_create();
+                ASSERT_EQ(net_add_conv2d(net, w.data(), c, h, wd, oc, k, k,
+                                         conv[2], conv[3], conv[4], groups,
+                                         bias.data(), &scale, 1, -128, 127,
+                                         "conv"),
+                          0);
+                std::vector<float> logits(expected.size());
+                ASSERT_EQ(net_run(net, inputs.data(), batch, logits.data()),
+                          0);
+                ASSERT_THAT(logits, ::testing::ElementsAreArray(expected))
+                    << xbar_size << " groups: " << groups;
+                net_destroy(net);
+            }
+        }
+    }
+
+    // Channels not divisible by the groups
+    set_config(get_cfg_file("digital/I_DIFF_W_DIFF_1XB.json").c_str());
+    const int32_t net = net_create();
+    std::vector<int32_t> w(3 * 2 * 3 * 3, 1);
+    ASSERT_EQ(net_add_conv2d(net, w.data(), c, h, wd, 3, 3, 3, 1, 0, 1, 2,
+                             nullptr, &scale, 1, -128, 127),
+              -1);
+    net_destroy(net);
+}
+
+TEST(NetworkTests, Pipeline) {
+    const int32_t batch = 8;
+    const float scale = 0.125f;
+    std::vector<int32_t> conv_w(4 * 2 * 3 * 3);
+    std::vector<int32_t> fc1_w(6 * 4 * 4 * 4);
+    std::vector<int32_t> fc2_w(3 * 6);
+    std::vector<int32_t> inputs(batch * 2 * 4 * 4);
+    for (auto *v : {&conv_w, &fc1_w, &fc2_w, &inputs}) {
+        for (size_t i = 0; i < v->size(); ++i) {
+            (*v)[i] = static_cast<int32_t>(i * 7 % 11) - 5;
+        }
+    }
+
+    set_config(get_cfg_file("analog/I_DIFF_W_DIFF_1XB.json").c_str());
+    update_config("{\"M\": 8, \"N\": 16}");
+    const int32_t net = net_create();
+    ASSERT_EQ(net_add_conv2d(net, conv_w.data(), 2, 4, 4, 4, 3, 3, 1, 1, 1, 1,
+                             nullptr, &scale, 1, 0, 127, "conv"),
+              0);
+    ASSERT_EQ(net_add_dense(net, fc1_w.data(), 6, 4 * 4 * 4, nullptr, &scale,
+                            1, 0, 127, "fc1"),
+              0);
+    ASSERT_EQ(net_add_dense(net, fc2_w.data(), 3, 6, nullptr, &scale, 1, -128,
+                            127, "fc2"),
+              0);
+    ASSERT_EQ(net_num_layers(net), 3);
+
+    std::vector<float> expected(batch * 3);
+    ASSERT_EQ(net_run(net, inputs.data(), batch, expected.data()), 0);
+    ASSERT_NE(std::count(expected.begin(), expected.end(), 0.0f), batch * 3);
+    double occupancy[3];
+    ASSERT_EQ(net_stage_occupancy(net, occupancy), -1) << "No pipelined run.";
+
+    for (uint32_t queue_depth : {1, 4}) {
+        std::vector<float> logits(batch * 3);
+        ASSERT_EQ(net_run_pipelined(net, inputs.data(), batch, logits.data(),
+                                    queue_depth),
+                  0);
+        ASSERT_THAT(logits, ::testing::ElementsAreArray(expected));
+        ASSERT_EQ(net_stage_occupancy(net, occupancy), 0);
+        for (double o : occupancy) {
+            ASSERT_GT(o, 0.0);
+            ASSERT_LE(o, 1.0);
+        }
+    }
+    net_destroy(net);
+}
+
+TEST(NetworkTests, TileParallelism) {
+    const int32_t batch = 6;
+    const float scale = 0.05f;
+    // 12 x 12 output pixels: the patches are gathered in several chunks
+    const int32_t hw = 12;
+    std::vector<int32_t> conv_w(4 * 2 * 3 * 3);
+    std::vector<int32_t> fc_w(5 * 4 * hw * hw);
+    std::vector<int32_t> inputs(batch * 2 * hw * hw);
+    for (auto *v : {&conv_w, &fc_w, &inputs}) {
+        for (size_t i = 0; i < v->size(); ++i) {
+            (*v)[i] = static_cast<int32_t>(i * 7 % 3) - 1;
+        }
+    }
+
+    // Read disturb: the results depend on the MVM order of each tile
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    update_config("{\"M\": 3, \"N\": 7, \"resolution\": 4, "
+                  "\"read_disturb\": true, \"V_read\": -0.4, "
+                  "\"t_read\": 100e-9, "
+                  "\"read_disturb_mitigation_strategy\": \"CELL_BASED\", "
+                  "\"read_disturb_update_tolerance\": 0.05}");
+
+    std::vector<std::vector<float>> logits;
+    for (uint32_t num_threads : {1, 4, 3}) {
+        const int32_t net = net_create();
+        ASSERT_EQ(net_add_conv2d(net, conv_w.data(), 2, hw, hw, 4, 3, 3, 1, 1,
+                                 1, 1, nullptr, &scale, 1, -1, 1, "conv"),
+                  0);
+        ASSERT_EQ(net_add_dense(net, fc_w.data(), 5, 4 * hw * hw, nullptr,
+                                &scale, 1, -128, 127, "fc"),
+                  0);
+        ASSERT_EQ(net_set_threads(net, num_threads), 0);
+
+        std::vector<float> out(batch * 5 * 3);
+        for (int32_t i = 0; i < 3; ++i) {
+            ASSERT_EQ(net_run(net, inputs.data(), batch,
+                              out.data() + i * batch * 5),
+                      0);
+        }
+        logits.push_back(out);
+        net_destroy(net);
+    }
+    ASSERT_EQ(logits[1], logits[0]);
+    ASSERT_EQ(logits[2], logits[0]);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
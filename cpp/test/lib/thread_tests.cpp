@@ -0,0 +1,160 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+#include <cstdlib>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "inc/test_helper.h"
+
+// Independent simulator instances must not share mutable state. Build with
+// -DTSAN=ON to run these tests under ThreadSanitizer.
+
+const int32_t num_threads = 8;
+const int32_t num_runs = 4;
+
+const char *const rd_update =
+    "{\"M\": 5, \"N\": 6, \"read_disturb\": true, \"V_read\": -0.4, "
+    "\"t_read\": 100e-9, \"read_disturb_mitigation_strategy\": "
+    "\"CELL_BASED\", \"read_disturb_update_tolerance\": 0.05}";
+
+std::vector<int32_t> ternary(size_t size, int32_t seed) {
+    std::vector<int32_t> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<int32_t>((i * 7 + seed * 5) % 3) - 1;
+    }
+    return v;
+}
+
+// Two dense layers, different weights per network
+int32_t create_network(int32_t seed) {
+    const float scale = 0.1f;
+    const std::vector<int32_t> w1 = ternary(12 * 16, seed);
+    const std::vector<int32_t> w2 = ternary(4 * 12, seed + 1);
+    const int32_t net = net_create();
+    EXPECT_EQ(net_add_dense(net, w1.data(), 12, 16, nullptr, &scale, 1, -1, 1,
+                            "fc1"),
+              0);
+    EXPECT_EQ(net_add_dense(net, w2.data(), 4, 12, nullptr, &scale, 1, -128,
+                            127, "fc2"),
+              0);
+    return net;
+}
+
+std::vector<float> run_network(int32_t net, const std::vector<int32_t> &x,
+                               int32_t batch) {
+    std::vector<float> logits(num_runs * batch * 4);
+    for (int32_t r = 0; r < num_runs; ++r) {
+        EXPECT_EQ(net_run(net, x.data(), batch, logits.data() + r * batch * 4),
+                  0);
+    }
+    return logits;
+}
+
+TEST(ThreadTests, IndependentNetworks) {
+    const int32_t batch = 3;
+    const std::vector<int32_t> x = ternary(batch * 16, 0);
+
+    // Read disturb (TNN) and a quantizing ADC (INT)
+    const std::vector<std::pair<std::string, std::string>> cfgs = {
+        {"analog/TNN_I.json", rd_update},
+        {"analog/SYM_ADC_1.json", "{\"M\": 5, \"N\": 6, \"I_BIT\": 2}"}};
+    for (const auto &cfg : cfgs) {
+        set_config(get_cfg_file(cfg.first).c_str());
+        update_config(cfg.second.c_str());
+
+        // Reference: all networks in one thread
+        std::vector<std::vector<float>> expected;
+        for (int32_t i = 0; i < num_threads; ++i) {
+            const int32_t net = create_network(i);
+            expected.push_back(run_network(net, x, batch));
+            net_destroy(net);
+        }
+
+        std::vector<int32_t> nets;
+        for (int32_t i = 0; i < num_threads; ++i) {
+            nets.push_back(create_network(i));
+        }
+        std::vector<std::vector<float>> logits(num_threads);
+        std::vector<std::thread> threads;
+        for (int32_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&, i] {
+                logits[i] = run_network(nets[i], x, batch);
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        for (int32_t i = 0; i < num_threads; ++i) {
+            ASSERT_EQ(logits[i], expected[i])
+                << cfg.first << ", network " << i;
+            net_destroy(nets[i]);
+        }
+    }
+}
+
+TEST(ThreadTests, ConcurrentSubmissions) {
+    const int32_t m_matrix = 5;
+    const int32_t n_matrix = 6;
+    const int32_t num_mvms = 50;
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    update_config(rd_update);
+
+    std::vector<int32_t> handles;
+    std::vector<std::vector<int32_t>> mats;
+    for (int32_t i = 0; i < num_threads; ++i) {
+        mats.push_back(ternary(m_matrix * n_matrix, i));
+        handles.push_back(xbar_create(mats[i].data(), m_matrix, n_matrix));
+        ASSERT_GE(handles[i], 0);
+    }
+    const std::vector<int32_t> vecs = ternary(num_mvms * n_matrix, 3);
+
+    // Each thread submits to its own crossbar and waits for every MVM
+    std::vector<std::vector<int32_t>> res(num_threads);
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i] {
+            res[i].assign(num_mvms * m_matrix, 0);
+            for (int32_t v = 0; v < num_mvms; ++v) {
+                const int64_t ticket = submit_mvm(
+                    handles[i], res[i].data() + v * m_matrix,
+                    vecs.data() + v * n_matrix, m_matrix, n_matrix);
+                EXPECT_EQ(wait_mvm(ticket), 0);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // Reference: synchronous MVMs on a fresh crossbar per matrix
+    for (int32_t i = 0; i < num_threads; ++i) {
+        set_config(get_cfg_file("analog/TNN_I.json").c_str());
+        update_config(rd_update);
+        ASSERT_EQ(cpy_mtrx(mats[i].data(), m_matrix, n_matrix), 0);
+        std::vector<int32_t> expected(num_mvms * m_matrix, 0);
+        for (int32_t v = 0; v < num_mvms; ++v) {
+            ASSERT_EQ(exe_mvm(expected.data() + v * m_matrix,
+                              const_cast<int32_t *>(vecs.data()) +
+                                  v * n_matrix,
+                              mats[i].data(), m_matrix, n_matrix),
+                      0);
+        }
+        ASSERT_EQ(res[i], expected) << "crossbar " << i;
+        ASSERT_EQ(xbar_destroy(handles[i]), 0);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,10 @@
+#include <algorithm>
 #include <cstdlib>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "inc/test_helper.h"
 
@@ -15,8 +19,8 @@ TEST(VarTests, VarTest) {
     int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
     ASSERT_EQ(status, 0) << "Matrix write operation failed.";
 
-    const std::vector<std::vector<float>> &ia_p_vec = get_ia_p();
-    const std::vector<std::vector<float>> &ia_m_vec = get_ia_m();
+    const nq::Plane<float> &ia_p_vec = get_ia_p();
+    const nq::Plane<float> &ia_m_vec = get_ia_m();
 
     for (int32_t m = 0; m < m_matrix; m++) {
         for (int32_t n = 0; n < n_matrix; n++) {
@@ -30,6 +34,475 @@ TEST(VarTests, VarTest) {
     }
 }
 
+TEST(VarTests, SnapshotTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 2;
+    int32_t mat[m_matrix * n_matrix] = {1, 1, -1, -1, 1, -1};
+    int32_t vec[n_matrix] = {1, -1};
+
+    std::string cfg = get_cfg_file("variability/variability.json");
+    set_config(cfg.c_str());
+
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    int32_t res[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+
+    const nq::Plane<float> ia_p_vec = get_ia_p();
+    const nq::Plane<float> ia_m_vec = get_ia_m();
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "acs_snapshot_test.bin")
+            .string();
+    ASSERT_EQ(save_xbar(path.c_str()), 0) << "Saving the snapshot failed.";
+
+    // New crossbar with new state variability, restored from the snapshot
+    set_config(cfg.c_str());
+    ASSERT_EQ(load_xbar(path.c_str()), 0) << "Loading the snapshot failed.";
+    ASSERT_EQ(get_ia_p(), ia_p_vec);
+    ASSERT_EQ(get_ia_m(), ia_m_vec);
+
+    int32_t res_loaded[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res_loaded, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res_loaded, ::testing::ElementsAreArray(res));
+
+    // Snapshots of a different config are rejected
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    ASSERT_EQ(load_xbar(path.c_str()), -1);
+
+    // Planes of the same size, but other weight segments or input bits
+    std::string int_cfg = get_cfg_file("analog/I_DIFF_W_DIFF_1XB.json");
+    set_config(int_cfg.c_str());
+    ASSERT_EQ(save_xbar(path.c_str()), 0) << "Saving the snapshot failed.";
+    for (const char *update : {"{\"SPLIT\": [2, 2, 4]}", "{\"I_BIT\": 4}"}) {
+        set_config(int_cfg.c_str());
+        update_config(update);
+        ASSERT_EQ(load_xbar(path.c_str()), -1) << update;
+    }
+    set_config(int_cfg.c_str());
+    ASSERT_EQ(load_xbar(path.c_str()), 0);
+
+    std::filesystem::remove(path);
+}
+
+TEST(VarTests, StorageTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1, 0, 1, 0, 1, 1, -1};
+    int32_t vec[n_matrix] = {1, -1, 0, 1};
+    std::string cfg = get_cfg_file("analog/TNN_I.json");
+
+    int32_t res_heap[m_matrix] = {0, 0, 0};
+    nq::Plane<int32_t> gd_p_heap;
+    for (const std::string storage : {"HEAP", "MMAP", "HUGEPAGE"}) {
+        set_config(cfg.c_str());
+        update_config(("{\"storage\": \"" + storage +
+                       "\", \"read_disturb\": true, \"V_read\": -0.4, "
+                       "\"t_read\": 100e-9}")
+                          .c_str());
+
+        int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+        ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+        int32_t res[m_matrix] = {0, 0, 0};
+        for (int32_t i = 0; i < 3; ++i) {
+            status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+            ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+        }
+
+        if (storage == "HEAP") {
+            std::copy(res, res + m_matrix, res_heap);
+            gd_p_heap = get_gd_p();
+        } else {
+            ASSERT_THAT(res, ::testing::ElementsAreArray(res_heap)) << storage;
+            ASSERT_EQ(get_gd_p(), gd_p_heap) << storage;
+        }
+    }
+}
+
+TEST(VarTests, IncrementalUpdateTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1, 0, 1, 0, 1, 1, -1};
+    int32_t vec[n_matrix] = {1, -1, 0, 1};
+    std::string cfg = get_cfg_file("analog/TNN_I.json");
+    const char *update = "{\"HRS\": 2.0, \"LRS\": 40.0, \"resolution\": 16}";
+
+    // Reference: crossbar created with the updated config
+    set_config(cfg.c_str());
+    update_config(update);
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    const nq::Plane<float> ia_p_ref = get_ia_p();
+    int32_t res_ref[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res_ref, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+
+    // Analog and ADC parameters are updated in place, weights are kept
+    set_config(cfg.c_str());
+    status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    const nq::Plane<int32_t> gd_p = get_gd_p();
+    update_config(update);
+    ASSERT_EQ(get_gd_p(), gd_p);
+    ASSERT_EQ(get_ia_p(), ia_p_ref);
+    int32_t res[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res, ::testing::ElementsAreArray(res_ref));
+
+    // Structural changes recreate the crossbar
+    update_config("{\"M\": 16}");
+    ASSERT_EQ(get_gd_p().size(), 16);
+    ASSERT_NE(get_gd_p(), gd_p);
+}
+
+TEST(VarTests, IncrementalUpdateReadDisturbTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1, 0, 1, 0, 1, 1, -1};
+    int32_t vec[n_matrix] = {1, -1, 0, 1};
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    update_config("{\"read_disturb\": true, \"V_read\": -0.4, "
+                  "\"t_read\": 100e-9, "
+                  "\"read_disturb_mitigation_strategy\": \"CELL_BASED\", "
+                  "\"read_disturb_update_tolerance\": 0.05}");
+    ASSERT_EQ(cpy_mtrx(mat, m_matrix, n_matrix), 0);
+    for (int32_t i = 0; i < 3; ++i) {
+        int32_t res[m_matrix] = {0, 0, 0};
+        ASSERT_EQ(exe_mvm(res, vec, mat, m_matrix, n_matrix), 0);
+    }
+    const nq::Plane<uint64_t> reads_p = get_consecutive_reads_p();
+    ASSERT_EQ(reads_p[0][0], 3);
+
+    // Unrelated analog updates keep the read disturb state
+    update_config("{\"HRS_NOISE\": 0.5}");
+    ASSERT_EQ(get_consecutive_reads_p(), reads_p);
+
+    // A new read voltage resets it
+    update_config("{\"V_read\": -0.5}");
+    ASSERT_EQ(get_consecutive_reads_p()[0][0], 0);
+}
+
+TEST(VarTests, ConfigFingerprintTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1, 0, 1, 0, 1, 1, -1};
+    int32_t vec[n_matrix] = {1, -1, 0, 1};
+
+    set_config(get_cfg_file("analog/TNN_I.json").c_str());
+    const uint64_t fingerprint = get_config_fingerprint();
+    int32_t status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    int32_t res[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+
+    // verbose does not affect the simulation
+    update_config("{\"verbose\": true}");
+    ASSERT_EQ(get_config_fingerprint(), fingerprint);
+    update_config("{\"verbose\": false, \"resolution\": 16}");
+    ASSERT_NE(get_config_fingerprint(), fingerprint);
+    update_config("{\"resolution\": 20}");
+    ASSERT_EQ(get_config_fingerprint(), fingerprint);
+
+    // Binary config: same config and results as the JSON config
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "acs_config_test.msgpack")
+            .string();
+    ASSERT_EQ(save_config(path.c_str()), 0) << "Saving the config failed.";
+    set_config(path.c_str());
+    ASSERT_EQ(get_config_fingerprint(), fingerprint);
+    status = cpy_mtrx(mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix write operation failed.";
+    int32_t res_bin[m_matrix] = {0, 0, 0};
+    status = exe_mvm(res_bin, vec, mat, m_matrix, n_matrix);
+    ASSERT_EQ(status, 0) << "Matrix-vector multiplication failed.";
+    ASSERT_THAT(res_bin, ::testing::ElementsAreArray(res));
+
+    ASSERT_EQ(save_config("/nonexistent/acs_config_test.msgpack"), -1);
+    std::filesystem::remove(path);
+}
+
+TEST(VarTests, DeferredAnalogWriteTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat_a[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1,
+                                          0, 1, 0,  1, 1,  -1};
+    // Partial writes: 2 x 4 and 3 x 2
+    int32_t mat_b[2 * n_matrix] = {-1, 1, 1, 0, 0, -1, -1, 1};
+    int32_t mat_c[m_matrix * 2] = {0, 1, 1, -1, -1, 0};
+    int32_t vec[n_matrix] = {1, -1, 0, 1};
+    std::string cfg = get_cfg_file("analog/TNN_I.json");
+
+    // Reference: currents programmed after every write
+    set_config(cfg.c_str());
+    ASSERT_EQ(cpy_mtrx(mat_a, m_matrix, n_matrix), 0);
+    get_ia_p();
+    ASSERT_EQ(cpy_mtrx(mat_b, 2, n_matrix), 0);
+    get_ia_p();
+    ASSERT_EQ(cpy_mtrx(mat_c, m_matrix, 2), 0);
+    const nq::Plane<float> ia_p_ref = get_ia_p();
+    const nq::Plane<float> ia_m_ref = get_ia_m();
+    int32_t res_ref[m_matrix] = {0, 0, 0};
+    ASSERT_EQ(exe_mvm(res_ref, vec, mat_a, m_matrix, n_matrix), 0);
+
+    // Currents programmed once for all written rows on the first analog MVM
+    set_config(cfg.c_str());
+    ASSERT_EQ(cpy_mtrx(mat_a, m_matrix, n_matrix), 0);
+    ASSERT_EQ(cpy_mtrx(mat_b, 2, n_matrix), 0);
+    ASSERT_EQ(cpy_mtrx(mat_c, m_matrix, 2), 0);
+    int32_t res[m_matrix] = {0, 0, 0};
+    ASSERT_EQ(exe_mvm(res, vec, mat_a, m_matrix, n_matrix), 0);
+    ASSERT_THAT(res, ::testing::ElementsAreArray(res_ref));
+    ASSERT_EQ(get_ia_p(), ia_p_ref);
+    ASSERT_EQ(get_ia_m(), ia_m_ref);
+}
+
+TEST(VarTests, RegionWriteTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    const int32_t mat_a[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1,
+                                                0, 1, 0,  1, 1,  -1};
+    // 2 x 2 region at row 1, column 1
+    const int32_t region[2 * 2] = {1, 0, -1, -1};
+    const int32_t mat_b[m_matrix * n_matrix] = {1, 0, -1, 1,  -1, 1,
+                                                0, 1, 0,  -1, -1, -1};
+    int32_t vec[n_matrix] = {1, -1, 1, 1};
+
+    // Scale: INT weights with several non-zero segments
+    const std::vector<std::pair<std::string, int32_t>> cfgs = {
+        {"analog/TNN_I.json", 1},
+        {"analog/TNN_IV_split.json", 1},
+        {"analog/BNN_III.json", 1},
+        {"analog/I_DIFF_W_DIFF_1XB.json", 37},
+        {"analog/I_UINT_W_OFFS.json", 37}};
+    for (const auto &cfg : cfgs) {
+        const std::string cfg_file = get_cfg_file(cfg.first);
+        const bool bnn = (cfg.first == "analog/BNN_III.json");
+        auto convert = [&](const int32_t *v, size_t size) {
+            std::vector<int32_t> out(size);
+            for (size_t i = 0; i < size; ++i) {
+                // BNN: no zero weights
+                out[i] = (bnn && (v[i] == 0)) ? 1 : v[i] * cfg.second;
+            }
+            return out;
+        };
+        std::vector<int32_t> a = convert(mat_a, m_matrix * n_matrix);
+        std::vector<int32_t> r = convert(region, 2 * 2);
+        std::vector<int32_t> b = convert(mat_b, m_matrix * n_matrix);
+
+        // Reference: full write of the changed matrix
+        set_config(cfg_file.c_str());
+        ASSERT_EQ(cpy_mtrx(b.data(), m_matrix, n_matrix), 0);
+        int32_t res_ref[m_matrix] = {0, 0, 0};
+        ASSERT_EQ(exe_mvm(res_ref, vec, b.data(), m_matrix, n_matrix), 0);
+        const nq::Plane<int32_t> gd_p_ref = get_gd_p();
+        const nq::Plane<int32_t> gd_m_ref = get_gd_m();
+        const nq::Plane<float> ia_p_ref = get_ia_p();
+
+        set_config(cfg_file.c_str());
+        ASSERT_EQ(cpy_mtrx(a.data(), m_matrix, n_matrix), 0);
+        int32_t res[m_matrix] = {0, 0, 0};
+        ASSERT_EQ(exe_mvm(res, vec, a.data(), m_matrix, n_matrix), 0);
+        ASSERT_EQ(write_region(r.data(), 1, 1, 2, 2), 0);
+        std::fill(res, res + m_matrix, 0);
+        ASSERT_EQ(exe_mvm(res, vec, b.data(), m_matrix, n_matrix), 0);
+        ASSERT_THAT(res, ::testing::ElementsAreArray(res_ref)) << cfg.first;
+        ASSERT_EQ(get_gd_p(), gd_p_ref) << cfg.first;
+        ASSERT_EQ(get_gd_m(), gd_m_ref) << cfg.first;
+        ASSERT_EQ(get_ia_p(), ia_p_ref) << cfg.first;
+        ASSERT_EQ(write_region(r.data(), 31, 1, 2, 2), -1);
+    }
+}
+
+TEST(VarTests, RegionWriteReadDisturbTest) {
+    const int32_t m_matrix = 3;
+    const int32_t n_matrix = 4;
+    int32_t mat_a[m_matrix * n_matrix] = {1, 0, -1, 1, -1, -1,
+                                          0, 1, 0,  1, 1,  -1};
+    int32_t region[2 * 2] = {1, 0, -1, -1};
+    int32_t mat_b[m_matrix * n_matrix] = {1, 0, -1, 1, -1, 1,
+                                          0, 1, 0, -1, -1, -1};
+    int32_t vec[n_matrix] = {1, 1, 1, 1};
+    const std::string cfg = get_cfg_file("analog/TNN_I.json");
+    const char *rd_cfg =
+        "{\"M\": 3, \"N\": 4, \"read_disturb\": true, \"V_read\": -0.4, "
+        "\"t_read\": 100e-9, \"read_disturb_mitigation_strategy\": "
+        "\"CELL_BASED\", \"read_disturb_update_tolerance\": 0.05}";
+
+    // Reference: the set-reset cycles of a full write
+    set_config(cfg.c_str());
+    update_config(rd_cfg);
+    ASSERT_EQ(cpy_mtrx(mat_a, m_matrix, n_matrix), 0);
+    ASSERT_EQ(cpy_mtrx(mat_b, m_matrix, n_matrix), 0);
+    const nq::Plane<uint64_t> cycles_p_ref = get_cycles_p();
+    const nq::Plane<uint64_t> cycles_m_ref = get_cycles_m();
+
+    set_config(cfg.c_str());
+    update_config(rd_cfg);
+    ASSERT_EQ(cpy_mtrx(mat_a, m_matrix, n_matrix), 0);
+    int32_t res[m_matrix] = {0, 0, 0};
+    ASSERT_EQ(exe_mvm(res, vec, mat_a, m_matrix, n_matrix), 0);
+    ASSERT_EQ(write_region(region, 1, 1, 2, 2), 0);
+    ASSERT_EQ(get_cycles_p(), cycles_p_ref);
+    ASSERT_EQ(get_cycles_m(), cycles_m_ref);
+
+    // Only the consecutive reads of the region cells are reset
+    const nq::Plane<uint64_t> &reads_p = get_consecutive_reads_p();
+    for (size_t m = 0; m < m_matrix; ++m) {
+        for (size_t n = 0; n < n_matrix; ++n) {
+            const bool in_region = (m >= 1) && (n >= 1) && (n < 3);
+            ASSERT_EQ(reads_p[m][n], in_region ? 0 : 1) << m << ", " << n;
+        }
+    }
+}
+
+TEST(VarTests, PlacementTest) {
+    // Three matrices packed into a 5 x 6 crossbar
+    const int32_t dims[3][2] = {{3, 4}, {2, 3}, {4, 2}};
+    const int32_t offs[3][2] = {{0, 0}, {3, 0}, {0, 4}};
+    const std::vector<int32_t> mats[3] = {
+        {1, -1, -1, 1, -1, 1, 1, 1, 1, 1, -1, -1},
+        {-1, 1, 1, 1, -1, 1},
+        {1, 1, -1, 1, 1, -1, -1, -1}};
+    int32_t vec[4] = {1, -1, 1, 1};
+
+    const std::vector<std::pair<std::string, int32_t>> cfgs = {
+        {"analog/TNN_I.json", 1},
+        {"analog/TNN_IV_split.json", 1},
+        {"analog/BNN_III.json", 1},
+        {"analog/I_DIFF_W_DIFF_1XB.json", 37},
+        {"analog/I_UINT_W_OFFS.json", 37}};
+    for (const auto &cfg : cfgs) {
+        for (const char *threshold : {"0.0", "0.5"}) {
+            const std::string cfg_file = get_cfg_file(cfg.first);
+            const std::string update =
+                std::string("{\"M\": 5, \"N\": 6, \"sparse_threshold\": ") +
+                threshold + "}";
+            std::vector<std::vector<int32_t>> w(3);
+            for (int32_t i = 0; i < 3; ++i) {
+                for (int32_t v : mats[i]) {
+                    w[i].push_back(v * cfg.second);
+                }
+            }
+
+            set_config(cfg_file.c_str());
+            update_config(update.c_str());
+            for (int32_t i = 0; i < 3; ++i) {
+                int32_t row_off = -1;
+                int32_t col_off = -1;
+                ASSERT_EQ(place_mtrx(w[i].data(), dims[i][0], dims[i][1],
+                                     &row_off, &col_off),
+                          0);
+                ASSERT_EQ(row_off, offs[i][0]) << cfg.first << ", " << i;
+                ASSERT_EQ(col_off, offs[i][1]) << cfg.first << ", " << i;
+            }
+            int32_t row_off = 0;
+            int32_t col_off = 0;
+            ASSERT_EQ(place_mtrx(w[0].data(), 3, 3, &row_off, &col_off), -1);
+
+            std::vector<std::vector<int32_t>> res(3);
+            for (int32_t i = 0; i < 3; ++i) {
+                res[i].assign(dims[i][0], 0);
+                ASSERT_EQ(exe_mvm_region(res[i].data(), vec, offs[i][0],
+                                         offs[i][1], dims[i][0], dims[i][1]),
+                          0);
+            }
+            ASSERT_EQ(exe_mvm_region(res[0].data(), vec, 4, 0, 2, 2), -1);
+
+            // Reference: each matrix on its own crossbar
+            for (int32_t i = 0; i < 3; ++i) {
+                set_config(cfg_file.c_str());
+                update_config(update.c_str());
+                ASSERT_EQ(cpy_mtrx(w[i].data(), dims[i][0], dims[i][1]), 0);
+                std::vector<int32_t> res_ref(dims[i][0], 0);
+                ASSERT_EQ(exe_mvm(res_ref.data(), vec, w[i].data(), dims[i][0],
+                                  dims[i][1]),
+                          0);
+                ASSERT_EQ(res[i], res_ref)
+                    << cfg.first << " threshold " << threshold << ", " << i;
+            }
+        }
+    }
+}
+
+TEST(VarTests, RowGatingTest) {
+    const int32_t m_matrix = 5;
+    const int32_t n_matrix = 4;
+    const int32_t mat[m_matrix * n_matrix] = {1,  -1, -1, 1,  -1, 1, 1,
+                                              1,  1,  1,  -1, -1, -1, 1,
+                                              -1, 1,  1,  1,  -1, -1};
+    int32_t vec[n_matrix] = {1, -1, 1, 1};
+    const int32_t rows[3] = {0, 2, 3};
+    const char *rd_update =
+        "{\"M\": 5, \"N\": 4, \"adc_telemetry\": true, \"read_disturb\": "
+        "true, \"V_read\": -0.4, \"t_read\": 100e-9, "
+        "\"read_disturb_mitigation_strategy\": \"CELL_BASED\", "
+        "\"read_disturb_update_tolerance\": 0.05}";
+
+    const std::vector<std::pair<std::string, int32_t>> cfgs = {
+        {"analog/TNN_I.json", 1},
+        {"analog/BNN_III.json", 1},
+        {"analog/I_DIFF_W_DIFF_1XB.json", 37},
+        {"analog/I_UINT_W_OFFS.json", 37},
+        {"digital/I_DIFF_W_DIFF_1XB.json", 37}};
+    for (const auto &cfg : cfgs) {
+        std::vector<int32_t> w(mat, mat + m_matrix * n_matrix);
+        for (int32_t &v : w) {
+            v *= cfg.second;
+        }
+        const bool analog = (cfg.first.rfind("analog/", 0) == 0);
+        const bool rd = (cfg.first == "analog/TNN_I.json");
+        // ADC telemetry: count the conversions of the analog MVM
+        const char *update =
+            rd ? rd_update
+               : (analog ? "{\"M\": 5, \"N\": 4, \"adc_telemetry\": true}"
+                         : "{\"M\": 5, \"N\": 4}");
+
+        set_config(get_cfg_file(cfg.first).c_str());
+        update_config(update);
+        ASSERT_EQ(cpy_mtrx(w.data(), m_matrix, n_matrix), 0);
+        std::vector<int32_t> res_ref(m_matrix, 0);
+        ASSERT_EQ(exe_mvm(res_ref.data(), vec, w.data(), m_matrix, n_matrix),
+                  0);
+        const uint64_t conversions = analog ? get_adc_num_conversions() : 0;
+
+        set_config(get_cfg_file(cfg.first).c_str());
+        update_config(update);
+        ASSERT_EQ(cpy_mtrx(w.data(), m_matrix, n_matrix), 0);
+        std::vector<int32_t> res(m_matrix, 7);
+        ASSERT_EQ(exe_mvm_rows(res.data(), vec, w.data(), m_matrix, n_matrix,
+                               rows, 3),
+                  0);
+        for (int32_t m = 0; m < m_matrix; ++m) {
+            const bool selected = (m != 1) && (m != 4);
+            ASSERT_EQ(res[m], selected ? 7 + res_ref[m] : 7)
+                << cfg.first << ", row " << m;
+        }
+        if (analog) {
+            ASSERT_EQ(get_adc_num_conversions() * m_matrix, conversions * 3)
+                << cfg.first;
+        }
+        if (rd) {
+            // Only the activated rows are read
+            const nq::Plane<uint64_t> &reads_p = get_consecutive_reads_p();
+            for (size_t m = 0; m < m_matrix; ++m) {
+                const bool selected = (m != 1) && (m != 4);
+                for (size_t n = 0; n < n_matrix; ++n) {
+                    ASSERT_EQ(reads_p[m][n], selected ? 1 : 0)
+                        << m << ", " << n;
+                }
+            }
+        }
+
+        const int32_t unsorted[2] = {2, 0};
+        ASSERT_EQ(exe_mvm_rows(res.data(), vec, w.data(), m_matrix, n_matrix,
+                               unsorted, 2),
+                  -1);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+// Replays a trace of cpy_mtrx/exe_mvm calls (recorded with start_trace() or
+// ACS_TRACE=<file>) on a crossbar of the given config, without Python.
+//
+// Usage: acs_replay <config.json> <trace> [repetitions]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helper/config.h"
+#include "helper/trace.h"
+
+namespace {
+
+struct LayerStats {
+    uint64_t cpy_ops = 0;
+    uint64_t mvm_ops = 0;
+    uint64_t macs = 0;
+    uint64_t mismatches = 0; // MVMs whose result differs from the trace
+    double time_s = 0.0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if ((argc < 3) || (argc > 4)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <config.json> <trace> [repetitions]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const int32_t repetitions = (argc == 4) ? std::atoi(argv[3]) : 1;
+    if (repetitions <= 0) {
+        std::cerr << "Number of repetitions must be positive." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!nq::Config::get_cfg().load_cfg(argv[1])) {
+        std::cerr << "Invalid config: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Load the complete trace first, the replay does not include file I/O
+    std::vector<nq::TraceRecord> records;
+    if (!nq::read_trace(argv[2], records)) {
+        return EXIT_FAILURE;
+    }
+    for (const auto &rec : records) {
+        if ((rec.m_matrix > CFG.M) || (rec.n_matrix > CFG.N)) {
+            std::cerr << "Layer " << rec.name << " (" << rec.m_matrix << "x"
+                      << rec.n_matrix << ") exceeds the crossbar size."
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto xbar = std::make_unique<nq::Crossbar>(CFG);
+    std::map<std::string, LayerStats> layers;
+    std::vector<int32_t> res(CFG.M);
+    const std::vector<int32_t> *mat = nullptr; // Last copied matrix
+    double total_s = 0.0;
+
+    for (int32_t r = 0; r < repetitions; ++r) {
+        for (const auto &record : records) {
+            LayerStats &stats = layers[record.name];
+            const auto start = std::chrono::steady_clock::now();
+            if (record.op == nq::TraceOp::CPY) {
+                xbar->write(record.mat.data(), record.m_matrix,
+                            record.n_matrix);
+                mat = &record.mat;
+                stats.cpy_ops++;
+            } else {
+                std::copy(record.res_in.begin(), record.res_in.end(),
+                          res.begin());
+                xbar->mvm(res.data(), record.vec.data(),
+                          (mat != nullptr) ? mat->data() : nullptr,
+                          record.m_matrix, record.n_matrix);
+                stats.mvm_ops++;
+                stats.macs += static_cast<uint64_t>(record.m_matrix) *
+                              record.n_matrix;
+                if (!std::equal(record.res_out.begin(), record.res_out.end(),
+                                res.begin())) {
+                    stats.mismatches++;
+                }
+            }
+            const std::chrono::duration<double> dt =
+                std::chrono::steady_clock::now() - start;
+            stats.time_s += dt.count();
+            total_s += dt.count();
+        }
+    }
+
+    LayerStats total;
+    std::cout << std::left << std::setw(32) << "layer" << std::right
+              << std::setw(10) << "cpy" << std::setw(12) << "mvm"
+              << std::setw(12) << "mismatch" << std::setw(12) << "time [s]"
+              << std::endl;
+    for (const auto &layer : layers) {
+        const LayerStats &stats = layer.second;
+        std::cout << std::left << std::setw(32) << layer.first << std::right
+                  << std::setw(10) << stats.cpy_ops << std::setw(12)
+                  << stats.mvm_ops << std::setw(12) << stats.mismatches
+                  << std::setw(12) << std::fixed << std::setprecision(4)
+                  << stats.time_s << std::endl;
+        total.cpy_ops += stats.cpy_ops;
+        total.mvm_ops += stats.mvm_ops;
+        total.macs += stats.macs;
+        total.mismatches += stats.mismatches;
+    }
+    std::cout << "Total: " << total.cpy_ops << " cpy, " << total.mvm_ops
+              << " mvm (" << total.mismatches << " differ from the trace) in "
+              << total_s << " s";
+    if (total_s > 0.0) {
+        std::cout << ", " << std::setprecision(1) << total.mvm_ops / total_s
+                  << " MVM/s, " << std::setprecision(3)
+                  << total.macs / total_s * 1e-9 << " GMAC/s";
+    }
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+}
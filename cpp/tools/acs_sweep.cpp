@@ -0,0 +1,64 @@
+/******************************************************************************
+ * Copyright (C) 2025 Rebecca Pelke                                           *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ ******************************************************************************/
+// Evaluates a list of config deltas (JSON array of objects, e.g.,
+// [{"resolution": 4}, {"resolution": 6, "alpha": 0.5}]) on a recorded trace
+// in parallel and writes the results to a CSV file.
+//
+// Usage: acs_sweep <base_config.json> <deltas.json> <trace> <results.csv>
+//                  [threads]
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "helper/config.h"
+#include "helper/trace.h"
+#include "sweep/sweep.h"
+
+int main(int argc, char **argv) {
+    if ((argc < 5) || (argc > 6)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <base_config.json> <deltas.json> <trace> <results.csv>"
+                     " [threads]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const uint32_t num_threads = (argc == 6) ? std::atoi(argv[5]) : 0;
+
+    std::unique_ptr<nq::Config> base = nq::Config::create();
+    if (!base->load_cfg(argv[1])) {
+        std::cerr << "Invalid config: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<nlohmann::json> deltas;
+    try {
+        std::ifstream file_stream(argv[2]);
+        deltas = nlohmann::json::parse(file_stream)
+                     .get<std::vector<nlohmann::json>>();
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid deltas file: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<nq::TraceRecord> workload;
+    if (!nq::read_trace(argv[3], workload)) {
+        return EXIT_FAILURE;
+    }
+
+    nq::SweepEngine engine(*base, std::move(workload));
+    const std::vector<nq::SweepResult> results =
+        engine.run(deltas, num_threads);
+    if (!nq::SweepEngine::write_csv(argv[4], results)) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "Evaluated " << results.size() << " points." << std::endl;
+    return EXIT_SUCCESS;
+}